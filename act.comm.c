@@ -42,7 +42,6 @@ void do_say (struct char_data *ch, char *argument, int cmd)
 void do_shout (struct char_data *ch, char *argument, int cmd)
 {
   static char buf1[MAX_STRING_LENGTH];
-  struct descriptor_data *i;
 
 
   if (IS_SET (ch->specials.act, PLR_NOSHOUT)) {
@@ -65,10 +64,7 @@ void do_shout (struct char_data *ch, char *argument, int cmd)
     send_to_char ("Ok.\n\r", ch);
     sprintf (buf1, "$n shouts '%s'", argument);
 
-    for (i = descriptor_list; i; i = i->next)
-      if (i->character != ch && !i->connected &&
-        !IS_SET (i->character->specials.act, PLR_NOSHOUT))
-        act (buf1, 0, ch, 0, i->character, TO_VICT);
+    broadcast (buf1, ch, BCAST_AWAKE | BCAST_SHOUT);
   }
 }
 
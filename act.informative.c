@@ -80,7 +80,7 @@ struct obj_data *get_object_in_equip_vis (struct char_data *ch,
   for ((*j) = 0; (*j) < MAX_WEAR; (*j)++)
     if (equipment[(*j)])
       if (CAN_SEE_OBJ (ch, equipment[(*j)]))
-        if (isname (arg, equipment[(*j)]->name))
+        if (obj_isname (arg, equipment[(*j)]))
           return (equipment[(*j)]);
 
   return (0);
@@ -881,13 +881,10 @@ void do_weather (struct char_data *ch, char *argument, int cmd)
 void do_help (struct char_data *ch, char *argument, int cmd)
 {
   extern char *spells[];        /* The list of spells (spells.c)         */
-  extern int top_of_helpt;
   extern struct help_index_element *help_index;
-  extern FILE *help_fl;
   extern char help[MAX_STRING_LENGTH];
 
-  int i, no, chk, bot, top, mid, minlen;
-  char buf[MAX_STRING_LENGTH], buffer[MAX_STRING_LENGTH];
+  struct help_index_element *entry;
 
 
   if (!ch->desc)
@@ -901,33 +898,10 @@ void do_help (struct char_data *ch, char *argument, int cmd)
       send_to_char ("No help available.\n\r", ch);
       return;
     }
-    bot = 0;
-    top = top_of_helpt;
-
-    for (;;) {
-      mid = (bot + top) / 2;
-      minlen = strlen (argument);
-
-      if (!(chk = strn_cmp (argument, help_index[mid].keyword, minlen))) {
-        fseek (help_fl, help_index[mid].pos, 0);
-        *buffer = '\0';
-        for (;;) {
-          FGETS (buf, 80, help_fl);
-          if (*buf == '#')
-            break;
-          strcat (buffer, buf);
-          strcat (buffer, "\r");
-        }
-        page_string (ch->desc, buffer, 1);
-        return;
-      } else if (bot >= top) {
-        send_to_char ("There is no help on that word.\n\r", ch);
-        return;
-      } else if (chk > 0)
-        bot = ++mid;
-      else
-        top = --mid;
-    }
+    if (!(entry = find_help (argument)))
+      send_to_char ("There is no help on that word.\n\r", ch);
+    else
+      page_slice (ch->desc, entry->text, entry->length);
     return;
   }
 
@@ -1130,7 +1104,7 @@ void do_where (struct char_data *ch, char *argument, int cmd)
   *buf = '\0';
 
   for (i = character_list; i; i = i->next)
-    if (isname (name, i->player.name) && CAN_SEE (ch, i)) {
+    if (char_isname (name, i) && CAN_SEE (ch, i)) {
       if ((i->in_room != NOWHERE) && ((GET_LEVEL (ch) > 20) ||
           (world[i->in_room].zone == world[ch->in_room].zone))) {
 
@@ -1155,7 +1129,7 @@ void do_where (struct char_data *ch, char *argument, int cmd)
 
   if (GET_LEVEL (ch) > 20) {
     for (k = object_list; k; k = k->next)
-      if (isname (name, k->name) && CAN_SEE_OBJ (ch, k) &&
+      if (obj_isname (name, k) && CAN_SEE_OBJ (ch, k) &&
         (k->in_room != NOWHERE)) {
         sprintf (buf, "%-30s- %s [%d]\n\r",
           k->short_description,
@@ -21,6 +21,7 @@ extern struct str_app_type str_app[];
 extern struct room_data *world;
 extern struct descriptor_data *descriptor_list;
 extern struct room_data *world;
+extern struct index_data *obj_index;
 
 /* extern functions */
 
@@ -35,6 +36,13 @@ void get (struct char_data *ch, struct obj_data *obj_object,
   char buffer[MAX_STRING_LENGTH];
 
   if (sub_object) {
+    if (GET_ITEM_TYPE (sub_object) == ITEM_CONTAINER &&
+      sub_object->obj_flags.value[3])   /* from a corpse */
+      EVENT (EVENT_LOOT, ch, obj_object->item_number >= 0 ?
+        obj_index[obj_object->item_number].virtual : -1,
+        obj_object->obj_flags.cost,
+        GET_ITEM_TYPE (obj_object) == ITEM_MONEY ?
+        obj_object->obj_flags.value[0] : 0);
     obj_from_obj (obj_object);
     obj_to_char (obj_object, ch);
     if (sub_object->carried_by == ch) {
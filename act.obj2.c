@@ -67,6 +67,7 @@ void name_from_drinkcon (struct obj_data *obj)
   if (*((obj->name) + i) == ' ') {
     new_name = str_dup ((obj->name) + i + 1);
     free (obj->name);
+    keywords_free (&obj->keywords);
     obj->name = new_name;
   }
 }
@@ -81,6 +82,7 @@ void name_to_drinkcon (struct obj_data *obj, int type)
   CREATE (new_name, char, strlen (obj->name) + strlen (drinknames[type]) + 2);
   sprintf (new_name, "%s %s", drinknames[type], obj->name);
   free (obj->name);
+  keywords_free (&obj->keywords);
   obj->name = new_name;
 }
 
@@ -552,7 +554,7 @@ void wear (struct char_data *ch, struct obj_data *obj_object, int keyword)
         obj_from_char (obj_object);
         equip_char (ch, obj_object, WEAR_LIGHT);
         if (obj_object->obj_flags.value[2])
-          world[ch->in_room].light++;
+          room_light (ch->in_room, 1);
       }
     }
     break;
@@ -973,7 +975,7 @@ void do_remove (struct char_data *ch, char *argument, int cmd)
 
         if (obj_object->obj_flags.type_flag == ITEM_LIGHT)
           if (obj_object->obj_flags.value[2])
-            world[ch->in_room].light--;
+            room_light (ch->in_room, -1);
 
         act ("You stop using $p.", FALSE, ch, obj_object, 0, TO_CHAR);
         act ("$n stops using $p.", TRUE, ch, obj_object, 0, TO_ROOM);
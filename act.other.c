@@ -180,7 +180,7 @@ void do_steal (struct char_data *ch, char *argument, int cmd)
 
       for (eq_pos = 0; (eq_pos < MAX_WEAR); eq_pos++)
         if (victim->equipment[eq_pos] &&
-          (isname (obj_name, victim->equipment[eq_pos]->name)) &&
+          (obj_isname (obj_name, victim->equipment[eq_pos])) &&
           CAN_SEE_OBJ (ch, victim->equipment[eq_pos])) {
           obj = victim->equipment[eq_pos];
           break;
@@ -507,7 +507,7 @@ void do_quaff (struct char_data *ch, char *argument, int cmd)
   if (!(temp = get_obj_in_list_vis (ch, buf, ch->carrying))) {
     temp = ch->equipment[HOLD];
     equipped = TRUE;
-    if ((temp == 0) || !isname (buf, temp->name)) {
+    if ((temp == 0) || !obj_isname (buf, temp)) {
       act ("You do not have that item.", FALSE, ch, 0, 0, TO_CHAR);
       return;
     }
@@ -550,7 +550,7 @@ void do_recite (struct char_data *ch, char *argument, int cmd)
   if (!(scroll = get_obj_in_list_vis (ch, buf, ch->carrying))) {
     scroll = ch->equipment[HOLD];
     equipped = TRUE;
-    if ((scroll == 0) || !isname (buf, scroll->name)) {
+    if ((scroll == 0) || !obj_isname (buf, scroll)) {
       act ("You do not have that item.", FALSE, ch, 0, 0, TO_CHAR);
       return;
     }
@@ -599,7 +599,7 @@ void do_use (struct char_data *ch, char *argument, int cmd)
 
   argument = one_argument (argument, buf);
 
-  if (ch->equipment[HOLD] == 0 || !isname (buf, ch->equipment[HOLD]->name)) {
+  if (ch->equipment[HOLD] == 0 || !obj_isname (buf, ch->equipment[HOLD])) {
     act ("You do not hold that item in your hand.", FALSE, ch, 0, 0, TO_CHAR);
     return;
   }
@@ -25,32 +25,48 @@ extern struct room_data *world;
 
 void parse_string (char *input, char *output, struct char_data *ch1,
   struct char_data *ch2, struct char_data *to);
-int action (int cmd);
 char *fread_action (FILE * fl);
 
 
+/* One message text of a social.  Texts are read once at boot and shared
+   between every social that uses the same words; those sent through
+   act() are compiled up front. */
+struct social_text {
+  char *line;                   /* the text with "\n\r", for send_to_char */
+  struct act_template *tmpl;    /* compiled form, for act() */
+  struct social_text *next;     /* in social_hash */
+};
+
 struct social_messg {
   int act_nr;
   int hide;
   int min_victim_position;      /* Position of victim */
 
   /* No argument was supplied */
-  char *char_no_arg;
-  char *others_no_arg;
+  struct social_text *char_no_arg;
+  struct social_text *others_no_arg;
 
   /* An argument was there, and a victim was found */
-  char *char_found;             /* if NULL, read no further, ignore args */
-  char *others_found;
-  char *vict_found;
+  struct social_text *char_found;       /* if NULL, read no further, ignore args */
+  struct social_text *others_found;
+  struct social_text *vict_found;
 
   /* An argument was there, but no victim was found */
-  char *not_found;
+  struct social_text *not_found;
 
   /* The victim turned out to be the character */
-  char *char_auto;
-  char *others_auto;
+  struct social_text *char_auto;
+  struct social_text *others_auto;
 } *soc_mess_list = 0;
 
+/* soc_mess_list entries by command number */
+static struct social_messg **social_index = 0;
+static int social_top = -1;
+
+#define SOCIAL_HASH_SIZE 256
+
+static struct social_text *social_hash[SOCIAL_HASH_SIZE];
+
 
 
 struct pose_type {
@@ -88,10 +104,49 @@ char *fread_action (FILE * fl)
 
 
 
+/* read a social message, sharing it with any earlier one of the same
+   text; if to_act it is also compiled for act() */
+static struct social_text *fread_social (FILE * fl, int to_act)
+{
+  struct social_text *text;
+  unsigned long hash;
+  char *str, *p;
+
+  if (!(str = fread_action (fl)))
+    return (0);
+
+  for (hash = 0, p = str; *p; p++)
+    hash = hash * 31 + (unsigned char) *p;
+  hash %= SOCIAL_HASH_SIZE;
+
+  for (text = social_hash[hash]; text; text = text->next)
+    if (!strncmp (text->line, str, p - str) &&
+      !strcmp (text->line + (p - str), "\n\r"))
+      break;
+
+  if (!text) {
+    CREATE (text, struct social_text, 1);
+    CREATE (text->line, char, strlen (str) + 3);
+    strcpy (text->line, str);
+    strcat (text->line, "\n\r");
+    text->next = social_hash[hash];
+    social_hash[hash] = text;
+  }
+
+  if (to_act && !text->tmpl)
+    text->tmpl = act_prepare (str);
+
+  free (str);
+  return (text);
+}
+
+
+
 void boot_social_messages (void)
 {
   FILE *fl;
-  int tmp, hide, min_pos;
+  int tmp, hide, min_pos, list_size = 0, i;
+  struct social_messg *action;
 
   if (!(fl = fopen (SOCMESS_FILE, "rb"))) {
     perror ("boot_social_messages");
@@ -107,118 +162,112 @@ void boot_social_messages (void)
     fscanf (fl, " %d \n", &min_pos);
 
     /* alloc a new cell */
-    if (!soc_mess_list) {
-      CREATE (soc_mess_list, struct social_messg, 1);
-      list_top = 0;
-    } else if (!(soc_mess_list = (struct social_messg *)
-        realloc (soc_mess_list, sizeof (struct social_messg) *
-          (++list_top + 1)))) {
-      perror ("boot_social_messages. realloc");
-      WIN32CLEANUP
-      exit (1);
+    if (++list_top >= list_size) {
+      list_size = list_size ? list_size * 2 : 64;
+      if (!(soc_mess_list = (struct social_messg *)
+          realloc (soc_mess_list, sizeof (struct social_messg) * list_size))) {
+        perror ("boot_social_messages. realloc");
+        WIN32CLEANUP
+        exit (1);
+      }
     }
+    action = &soc_mess_list[list_top];
+    memset (action, 0, sizeof (struct social_messg));
 
     /* read the stuff */
-    soc_mess_list[list_top].act_nr = tmp;
-    soc_mess_list[list_top].hide = hide;
-    soc_mess_list[list_top].min_victim_position = min_pos;
+    action->act_nr = tmp;
+    action->hide = hide;
+    action->min_victim_position = min_pos;
 
-    soc_mess_list[list_top].char_no_arg = fread_action (fl);
-    soc_mess_list[list_top].others_no_arg = fread_action (fl);
+    action->char_no_arg = fread_social (fl, FALSE);
+    action->others_no_arg = fread_social (fl, TRUE);
 
-    soc_mess_list[list_top].char_found = fread_action (fl);
+    action->char_found = fread_social (fl, TRUE);
 
     /* if no char_found, the rest is to be ignored */
-    if (!soc_mess_list[list_top].char_found)
+    if (!action->char_found)
       continue;
 
-    soc_mess_list[list_top].others_found = fread_action (fl);
-    soc_mess_list[list_top].vict_found = fread_action (fl);
+    action->others_found = fread_social (fl, TRUE);
+    action->vict_found = fread_social (fl, TRUE);
 
-    soc_mess_list[list_top].not_found = fread_action (fl);
+    action->not_found = fread_social (fl, FALSE);
 
-    soc_mess_list[list_top].char_auto = fread_action (fl);
+    action->char_auto = fread_social (fl, FALSE);
 
-    soc_mess_list[list_top].others_auto = fread_action (fl);
+    action->others_auto = fread_social (fl, TRUE);
   }
   fclose (fl);
-}
 
+  /* index the socials by command number */
+  for (i = 0; i <= list_top; i++)
+    social_top = MAX (social_top, soc_mess_list[i].act_nr);
 
+  if (social_top >= 0)
+    CREATE (social_index, struct social_messg *, social_top + 1);
 
+  for (i = 0; i <= list_top; i++)
+    if (soc_mess_list[i].act_nr >= 0)
+      social_index[soc_mess_list[i].act_nr] = &soc_mess_list[i];
+}
 
-int find_action (int cmd)
-{
-  int bot, top, mid;
-
-  bot = 0;
-  top = list_top;
 
-  if (top < 0)
-    return (-1);
 
-  for (;;) {
-    mid = (bot + top) / 2;
 
-    if (soc_mess_list[mid].act_nr == cmd)
-      return (mid);
-    if (bot == top)
-      return (-1);
+struct social_messg *find_action (int cmd)
+{
+  if (cmd < 0 || cmd > social_top)
+    return (0);
 
-    if (soc_mess_list[mid].act_nr > cmd)
-      top = --mid;
-    else
-      bot = ++mid;
-  }
+  return (social_index[cmd]);
 }
 
 
 
-
+#define SOCIAL_LINE(text)  ((text) ? (text)->line : 0)
+#define SOCIAL_ACT(text)   ((text) ? (text)->tmpl : 0)
 
 void do_action (struct char_data *ch, char *argument, int cmd)
 {
-  int act_nr;
-  char buf[MAX_INPUT_LENGTH], tmp[MAX_STRING_LENGTH];
+  char buf[MAX_INPUT_LENGTH];
   struct social_messg *action;
-  struct char_data *i, *vict;
+  struct char_data *vict;
 
-  if ((act_nr = find_action (cmd)) < 0) {
+  if (!(action = find_action (cmd))) {
     send_to_char ("That action is not supported.\n\r", ch);
     return;
   }
 
-  action = &soc_mess_list[act_nr];
-
   if (action->char_found)
     one_argument (argument, buf);
   else
     *buf = '\0';
 
   if (!*buf) {
-    send_to_char (action->char_no_arg, ch);
-    send_to_char ("\n\r", ch);
-    act (action->others_no_arg, action->hide, ch, 0, 0, TO_ROOM);
+    send_to_char (SOCIAL_LINE (action->char_no_arg), ch);
+    act_prepared (SOCIAL_ACT (action->others_no_arg), action->hide, ch, 0, 0,
+      TO_ROOM);
     return;
   }
 
   if (!(vict = get_char_room_vis (ch, buf))) {
-    send_to_char (action->not_found, ch);
-    send_to_char ("\n\r", ch);
+    send_to_char (SOCIAL_LINE (action->not_found), ch);
   } else if (vict == ch) {
-    send_to_char (action->char_auto, ch);
-    send_to_char ("\n\r", ch);
-    act (action->others_auto, action->hide, ch, 0, 0, TO_ROOM);
+    send_to_char (SOCIAL_LINE (action->char_auto), ch);
+    act_prepared (SOCIAL_ACT (action->others_auto), action->hide, ch, 0, 0,
+      TO_ROOM);
   } else {
     if (GET_POS (vict) < action->min_victim_position) {
       act ("$N is not in a proper position for that.", FALSE, ch, 0, vict,
         TO_CHAR);
     } else {
-      act (action->char_found, 0, ch, 0, vict, TO_CHAR);
+      act_prepared (SOCIAL_ACT (action->char_found), 0, ch, 0, vict, TO_CHAR);
 
-      act (action->others_found, action->hide, ch, 0, vict, TO_NOTVICT);
+      act_prepared (SOCIAL_ACT (action->others_found), action->hide, ch, 0,
+        vict, TO_NOTVICT);
 
-      act (action->vict_found, action->hide, ch, 0, vict, TO_VICT);
+      act_prepared (SOCIAL_ACT (action->vict_found), action->hide, ch, 0, vict,
+        TO_VICT);
     }
   }
 }
@@ -241,7 +290,7 @@ void do_insult (struct char_data *ch, char *argument, int cmd)
         sprintf (buf, "You insult %s.\n\r", GET_NAME (victim));
         send_to_char (buf, ch);
 
-        switch (OS_RAND () % 3) {
+        switch (number (0, 2)) {
         case 0:{
             if (GET_SEX (ch) == SEX_MALE) {
               if (GET_SEX (victim) == SEX_MALE)
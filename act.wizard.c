@@ -431,6 +431,7 @@ void do_stat (struct char_data *ch, char *argument, int cmd)
       strcat (buf, "\n\r");
       send_to_char (buf, ch);
 
+      obj_timer_sync (j);
       sprintf (buf, "Weight: %d, Value: %d, Cost/day: %d, Timer: %d\n\r",
         j->obj_flags.weight, j->obj_flags.cost,
         j->obj_flags.cost_per_day, j->obj_flags.timer);
@@ -765,7 +766,7 @@ void do_stat (struct char_data *ch, char *argument, int cmd)
             apply_types[(int)aff->location], aff->modifier);
           send_to_char (buf, ch);
           sprintf (buf, "     Expires in %3d hours, Bits set ",
-            aff->duration);
+            affect_duration (aff));
           send_to_char (buf, ch);
           sprintbit (aff->bitvector, affected_bits, buf);
           strcat (buf, "\n\r");
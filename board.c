@@ -5,49 +5,73 @@
 #include "comm.h"
 #include "interpreter.h"
 #include "handler.h"
+#include "db.h"
 #include "prototypes.h"
 
-#define MAX_MSGS 50             /* Max number of messages.          */
-#define SAVE_FILE "board.messages"      /* Name of file for saving messages */
-#define BOARD_OBJECT  xxx       /* what are we?                     */
-#define BOARD_ROOM    xxx       /* where are we?                    */
+#define SAVE_FILE "board.log"   /* Name of file for saving messages */
+#define OLD_SAVE_FILE "board.messages"  /* where the one board used to be */
+#define OLD_BOARD 3099          /* ...and its vnum                  */
 #define MAX_MESSAGE_LENGTH 4000 /* that should be enough            */
-
-char *msgs[MAX_MSGS];
-char *head[MAX_MSGS];
-int msg_num;
-
-void board_write_msg (struct char_data *ch, char *arg);
-int board_display_msg (struct char_data *ch, char *arg);
-int board_remove_msg (struct char_data *ch, char *arg);
-void board_save_board (void);
+#define BOARD_COMPACT 65536L    /* rewrite the log past this much junk */
+
+/* The messages of all the boards are in one log, each new message and
+   each removal a record at the end of it.  Only the headers are kept in
+   memory; the text is read from the log when someone reads it.  When
+   enough of the log is removed messages, it is written anew.          */
+
+#define BOARD_POST   1          /* a message, head and text follow  */
+#define BOARD_REMOVE 2          /* message id was removed           */
+
+struct board_rec {
+  int type;
+  int vnum;                     /* of the board object              */
+  long id;                      /* of the message                   */
+  int head_len;                 /* with the '\0's                   */
+  int text_len;
+};
+
+struct board_msg {
+  long id;
+  char *head;
+  char *text;                   /* only while it is being written   */
+  long pos;                     /* of the text in the log, -1 if not there yet */
+  int text_len;
+};
+
+struct board_data {
+  int vnum;
+  struct board_msg **msg;       /* in the order they were posted    */
+  int msg_num, msg_max;
+  struct board_data *next;
+};
+
+extern struct room_data *world;
+extern struct index_data *obj_index;
+
+struct board_data *board_list = 0;
+long board_next_id = 1;
+long board_junk = 0;            /* bytes of the log no longer wanted */
+
+struct board_data *board_find (struct char_data *ch);
+void board_write_msg (struct char_data *ch, struct board_data *b, char *arg);
+int board_display_msg (struct char_data *ch, struct board_data *b,
+  char *arg);
+int board_remove_msg (struct char_data *ch, struct board_data *b, char *arg);
+void board_done_msg (char **text);
 void board_load_board (void);
-void board_reset_board (void);
+void board_compact (void);
 void error_log (char *str);
-void board_fix_long_desc (int num, char *headers[MAX_MSGS]);
-int board_show_board (struct char_data *ch, char *arg);
+int board_show_board (struct char_data *ch, struct board_data *b, char *arg);
 
 /* I have used cmd number 180-182 as the cmd numbers here. */
 /* The commands would be, in order : NOTE <header>         */
 /* READ <message number>, REMOVE <message number>          */
 /* LOOK AT BOARD should give the long desc of the board    */
 /* and that should equal a list of message numbers and     */
-/* headers. This is done by calling a function that sets   */
-/* the long desc in the board object. This function is     */
-/* called when someone does a REMOVE or NOTE command.      */
-/* I have named the function board_fix_long_desc(). In the */
-/* board_write_msg() function there is a part that should  */
-/* be replaced with a call to some dreadful routine used   */
-/* by the STRING command to receive player input. It is    */
-/* reputed to lurk somewhere within the limits of an evil  */
-/* file named act.comm.c.....*/
-
-/* saving the board after the addition of a new messg      */
-/* poses a slight problem, since the text isn't actually   */
-/* entered in board_write. What I'll do is to let board()  */
-/* save the first time a 'look' is issued in the room..    */
-/* ugh! that's ugly - gotta think of something better.     */
-/* -quinn                                                  */
+/* headers.                                                */
+
+/* A message is saved once its text has been entered; the  */
+/* STRING system calls board_done_msg() when it's done.    */
 
 /* And here is the board...correct me if I'm wrong. */
 
@@ -55,6 +79,7 @@ int board_show_board (struct char_data *ch, char *arg);
 int board (struct char_data *ch, int cmd, char *arg)
 {
   static int has_loaded = 0;
+  struct board_data *b;
 
   if (!ch->desc)
     return (FALSE);             /* By MS or all NPC's will be trapped at the board */
@@ -69,62 +94,194 @@ int board (struct char_data *ch, int cmd, char *arg)
     has_loaded = 1;
   }
 
+  if (!(b = board_find (ch)))
+    return (FALSE);
+
   switch (cmd) {
   case 15:                     /* look */
-    return (board_show_board (ch, arg));
+    return (board_show_board (ch, b, arg));
   case 149:                    /* write */
-    board_write_msg (ch, arg);
+    board_write_msg (ch, b, arg);
     return 1;
   case 63:                     /* read */
-    return (board_display_msg (ch, arg));
+    return (board_display_msg (ch, b, arg));
   case 66:                     /* remove */
-    return (board_remove_msg (ch, arg));
+    return (board_remove_msg (ch, b, arg));
   default:
     return 0;
   }
 }
 
 
-void board_write_msg (struct char_data *ch, char *arg)
+/* the board of vnum, made if there is none */
+struct board_data *board_get (int vnum)
 {
-  if (msg_num > MAX_MSGS - 1) {
-    send_to_char ("The board is full already.\n\r", ch);
-    return;
+  struct board_data *b;
+
+  for (b = board_list; b; b = b->next)
+    if (b->vnum == vnum)
+      return (b);
+
+  CREATE (b, struct board_data, 1);
+  b->vnum = vnum;
+  b->next = board_list;
+  board_list = b;
+
+  return (b);
+}
+
+
+/* The board ch is using; special() looks in the same places, in the
+   same order, for the object to call */
+struct board_data *board_find (struct char_data *ch)
+{
+  struct obj_data *obj = 0;
+  int j;
+
+  for (j = 0; j < MAX_WEAR && !obj; j++)
+    if (ch->equipment[j] && ch->equipment[j]->item_number >= 0 &&
+      obj_index[ch->equipment[j]->item_number].func == board)
+      obj = ch->equipment[j];
+
+  if (!obj)
+    for (obj = ch->carrying; obj; obj = obj->next_content)
+      if (obj->item_number >= 0 && obj_index[obj->item_number].func == board)
+        break;
+
+  if (!obj)
+    for (obj = world[ch->in_room].contents; obj; obj = obj->next_content)
+      if (obj->item_number >= 0 && obj_index[obj->item_number].func == board)
+        break;
+
+  return (obj ? board_get (obj_index[obj->item_number].virtual) : 0);
+}
+
+
+void board_add_msg (struct board_data *b, struct board_msg *msg)
+{
+  if (b->msg_num >= b->msg_max) {
+    b->msg_max = b->msg_max ? b->msg_max * 2 : 16;
+    if (b->msg)
+      RECREATE (b->msg, struct board_msg *, b->msg_max);
+    else
+      CREATE (b->msg, struct board_msg *, b->msg_max);
   }
+  b->msg[b->msg_num++] = msg;
+}
+
+
+/* take message ind off the board and free it */
+void board_drop_msg (struct board_data *b, int ind)
+{
+  struct board_msg *msg = b->msg[ind];
+
+  for (; ind < b->msg_num - 1; ind++)
+    b->msg[ind] = b->msg[ind + 1];
+  b->msg_num--;
+
+  free (msg->head);
+  if (msg->text)
+    free (msg->text);
+  free (msg);
+}
+
+
+/* append a record to the log; returns where its text went, or -1 */
+long board_append (struct board_rec *rec, char *head, char *text)
+{
+  FILE *the_file;
+  long pos;
+
+  if (!(the_file = fopen (SAVE_FILE, "ab"))) {
+    error_log ("Unable to open/create savefile..\n\r");
+    return (-1);
+  }
+  fseek (the_file, 0L, 2);
+  pos = ftell (the_file) + sizeof (struct board_rec) + rec->head_len;
+
+  fwrite (rec, sizeof (struct board_rec), 1, the_file);
+  if (rec->head_len)
+    fwrite (head, sizeof (char), rec->head_len, the_file);
+  if (rec->text_len)
+    fwrite (text, sizeof (char), rec->text_len, the_file);
+
+  if (fclose (the_file)) {
+    error_log ("Unable to write savefile..\n\r");
+    return (-1);
+  }
+  return (pos);
+}
+
+
+void board_write_msg (struct char_data *ch, struct board_data *b, char *arg)
+{
+  struct board_msg *msg;
+
   /* skip blanks */
   for (; isspace ((int)*arg); arg++);
   if (!*arg) {
     send_to_char ("We must have a headline!\n\r", ch);
     return;
   }
-  head[msg_num] = (char *) malloc (strlen (arg) + strlen (GET_NAME (ch)) + 4);
+
+  CREATE (msg, struct board_msg, 1);
+  msg->id = board_next_id++;
+  msg->pos = -1;
+  CREATE (msg->head, char, strlen (arg) + strlen (GET_NAME (ch)) + 4);
   /* +4 is for a space and '()' around the character name. */
-  if (!head[msg_num]) {
-    error_log ("Malloc for board header failed.\n\r");
-    send_to_char ("The board is malfunctioning - sorry.\n\r", ch);
-    return;
-  }
-  strcpy (head[msg_num], arg);
-  /* Is this clumsy?  - four strcat() in a row I mean.. */
-  strcat (head[msg_num], " (");
-  strcat (head[msg_num], GET_NAME (ch));
-  strcat (head[msg_num], ")");
-  msgs[msg_num] = NULL;
+  sprintf (msg->head, "%s (%s)", arg, GET_NAME (ch));
+  board_add_msg (b, msg);
 
   send_to_char ("Write your message. Terminate with a @.\n\r\n\r", ch);
   act ("$n starts to write a message.", TRUE, ch, 0, 0, TO_ROOM);
 
-  ch->desc->str = &msgs[msg_num];
+  ch->desc->str = &msg->text;
   ch->desc->max_str = MAX_MESSAGE_LENGTH;
+  ch->desc->str_done = board_done_msg;
+}
+
 
-  msg_num++;
+/* The text of a message has been written; save it */
+void board_done_msg (char **text)
+{
+  struct board_data *b;
+  struct board_msg *msg;
+  struct board_rec rec;
+  int ind;
+
+  for (b = board_list; b; b = b->next) {
+    for (ind = 0; ind < b->msg_num && &b->msg[ind]->text != text; ind++);
+    if (ind < b->msg_num)
+      break;
+  }
+  if (!b)
+    return;
+  msg = b->msg[ind];
+
+  if (!msg->text) {             /* nothing was written after all */
+    board_drop_msg (b, ind);
+    return;
+  }
+
+  rec.type = BOARD_POST;
+  rec.vnum = b->vnum;
+  rec.id = msg->id;
+  rec.head_len = strlen (msg->head) + 1;
+  rec.text_len = strlen (msg->text) + 1;
+
+  if ((msg->pos = board_append (&rec, msg->head, msg->text)) >= 0) {
+    msg->text_len = rec.text_len;
+    free (msg->text);
+    msg->text = 0;
+  }
 }
 
 
-int board_remove_msg (struct char_data *ch, char *arg)
+int board_remove_msg (struct char_data *ch, struct board_data *b, char *arg)
 {
   int ind, msg;
   char buf[256], number[MAX_INPUT_LENGTH];
+  struct board_rec rec;
 
   if (GET_LEVEL (ch) < 10) {
     send_to_char ("Due to misuse of the REMOVE command, only 10th level\n\r",
@@ -139,114 +296,184 @@ int board_remove_msg (struct char_data *ch, char *arg)
     return (0);
   if (!(msg = atoi (number)))
     return (0);
-  if (!msg_num) {
+  if (!b->msg_num) {
     send_to_char ("The board is empty!\n\r", ch);
     return (1);
   }
-  if (msg < 1 || msg > msg_num) {
+  if (msg < 1 || msg > b->msg_num) {
     send_to_char ("That message exists only in your imagination..\n\r", ch);
     return (1);
   }
 
-  ind = msg;
-  free (head[--ind]);
-  if (msgs[ind])
-    free (msgs[ind]);
-  for (; ind < msg_num - 1; ind++) {
-    head[ind] = head[ind + 1];
-    msgs[ind] = msgs[ind + 1];
+  ind = msg - 1;
+  if (b->msg[ind]->pos < 0) {
+    send_to_char ("Someone is still writing that one.\n\r", ch);
+    return (1);
   }
-  msg_num--;
+
+  rec.type = BOARD_REMOVE;
+  rec.vnum = b->vnum;
+  rec.id = b->msg[ind]->id;
+  rec.head_len = rec.text_len = 0;
+  board_append (&rec, 0, 0);
+
+  board_junk += 2 * sizeof (struct board_rec) + strlen (b->msg[ind]->head) +
+    1 + b->msg[ind]->text_len;
+  board_drop_msg (b, ind);
+
   send_to_char ("Message removed.\n\r", ch);
-  sprintf (buf, "$n just removed message %d.", ind + 1);
+  sprintf (buf, "$n just removed message %d.", msg);
   act (buf, FALSE, ch, 0, 0, TO_ROOM);
-  board_save_board ();
+
+  if (board_junk > BOARD_COMPACT)
+    board_compact ();
 
   return (1);
 }
 
-void board_save_board (void)
-{
-  FILE *the_file;
-  int ind, len;
-  if (!msg_num) {
-    error_log ("No messages to save.\n\r");
-    return;
-  }
-  the_file = fopen (SAVE_FILE, "wb");
-  if (!the_file) {
-    error_log ("Unable to open/create savefile..\n\r");
-    return;
-  }
-  fwrite (&msg_num, sizeof (int), 1, the_file);
-  for (ind = 0; ind < msg_num; ind++) {
-    len = strlen (head[ind]) + 1;
-    fwrite (&len, sizeof (int), 1, the_file);
-    fwrite (head[ind], sizeof (char), len, the_file);
-    len = strlen (msgs[ind]) + 1;
-    fwrite (&len, sizeof (int), 1, the_file);
-    fwrite (msgs[ind], sizeof (char), len, the_file);
-  }
-  fclose (the_file);
-  board_fix_long_desc (msg_num, head);
-  return;
-}
 
+/* Read the log, or make it from the old single board's file */
 void board_load_board (void)
 {
   FILE *the_file;
-  int ind, len = 0;
-
-  board_reset_board ();
-  the_file = fopen (SAVE_FILE, "rb");
-  if (!the_file) {
-    error_log ("Can't open message file. Board will be empty.\n\r");
-    return;
-  }
-  fread (&msg_num, sizeof (int), 1, the_file);
+  struct board_rec rec;
+  struct board_msg *msg;
+  struct board_data *b;
+  int ind, num, len;
+  long pos = 0;
+
+  if (!(the_file = fopen (SAVE_FILE, "rb"))) {
+    if (!(the_file = fopen (OLD_SAVE_FILE, "rb")))
+      return;
 
-  if (msg_num < 1 || msg_num > MAX_MSGS || feof (the_file)) {
-    error_log ("Board-message file corrupt or nonexistent.\n\r");
+    /* messages of the old board, one after the other */
+    if (fread (&num, sizeof (int), 1, the_file) == 1)
+      for (ind = 0; ind < num; ind++) {
+        CREATE (msg, struct board_msg, 1);
+        if (fread (&len, sizeof (int), 1, the_file) < 1 || len < 1)
+          break;
+        CREATE (msg->head, char, len + 1);
+        fread (msg->head, sizeof (char), len, the_file);
+        if (fread (&len, sizeof (int), 1, the_file) < 1 || len < 1)
+          break;
+        CREATE (msg->text, char, len + 1);
+        fread (msg->text, sizeof (char), len, the_file);
+
+        msg->id = board_next_id++;
+        board_add_msg (board_get (OLD_BOARD), msg);
+        board_done_msg (&msg->text);
+      }
     fclose (the_file);
     return;
   }
-  for (ind = 0; ind < msg_num; ind++) {
-    fread (&len, sizeof (int), 1, the_file);
-    head[ind] = (char *) malloc (len + 1);
-    if (!head[ind]) {
-      error_log ("Malloc for board header failed.\n\r");
-      board_reset_board ();
-      fclose (the_file);
-      return;
+
+  while (fread (&rec, sizeof (struct board_rec), 1, the_file) == 1) {
+    pos += sizeof (struct board_rec);
+    if (rec.head_len < 0 || rec.text_len < 0 ||
+      rec.text_len > MAX_MESSAGE_LENGTH + 3) {
+      error_log ("Board-message file corrupt.\n\r");
+      break;
     }
-    fread (head[ind], sizeof (char), len, the_file);
-    fread (&len, sizeof (int), 1, the_file);
-    msgs[ind] = (char *) malloc (len + 1);
-    if (!msgs[ind]) {
-      error_log ("Malloc for board msg failed..\n\r");
-      board_reset_board ();
-      fclose (the_file);
-      return;
+
+    b = board_get (rec.vnum);
+    if (rec.id >= board_next_id)
+      board_next_id = rec.id + 1;
+
+    if (rec.type == BOARD_REMOVE) {
+      for (ind = 0; ind < b->msg_num; ind++)
+        if (b->msg[ind]->id == rec.id) {
+          board_junk += 2 * sizeof (struct board_rec) +
+            strlen (b->msg[ind]->head) + 1 + b->msg[ind]->text_len;
+          board_drop_msg (b, ind);
+          break;
+        }
+      continue;
+    }
+
+    CREATE (msg, struct board_msg, 1);
+    CREATE (msg->head, char, rec.head_len + 1);
+    if (fread (msg->head, sizeof (char), rec.head_len, the_file) <
+      (size_t) rec.head_len) {
+      free (msg->head);
+      free (msg);
+      break;
     }
-    fread (msgs[ind], sizeof (char), len, the_file);
+    msg->id = rec.id;
+    msg->pos = pos + rec.head_len;
+    msg->text_len = rec.text_len;
+    pos = msg->pos + rec.text_len;
+    fseek (the_file, pos, 0);
+
+    board_add_msg (b, msg);
   }
+
   fclose (the_file);
-  board_fix_long_desc (msg_num, head);
-  return;
 }
 
-void board_reset_board (void)
+
+/* Write the log anew, with just the messages still on the boards */
+void board_compact (void)
 {
-  int ind;
-  for (ind = 0; ind < MAX_MSGS; ind++) {
-    free (head[ind]);
-    free (msgs[ind]);
+  FILE *old_file, *new_file;
+  struct board_data *b;
+  struct board_msg *msg;
+  struct board_rec rec;
+  char text[MAX_MESSAGE_LENGTH + 4];
+  long *new_pos, pos = 0;
+  int ind, num = 0;
+
+  for (b = board_list; b; b = b->next)
+    num += b->msg_num;
+  if (!num)
+    num = 1;
+
+  if (!(old_file = fopen (SAVE_FILE, "rb")))
+    return;
+  if (!(new_file = fopen (SAVE_FILE ".new", "wb"))) {
+    error_log ("Unable to compact savefile..\n\r");
+    fclose (old_file);
+    return;
   }
-  msg_num = 0;
-  board_fix_long_desc (0, 0);
-  return;
+  CREATE (new_pos, long, num);
+
+  rec.type = BOARD_POST;
+  num = 0;
+  for (b = board_list; b; b = b->next)
+    for (ind = 0; ind < b->msg_num; ind++)
+      if ((msg = b->msg[ind])->pos >= 0) {
+        fseek (old_file, msg->pos, 0);
+        fread (text, sizeof (char), msg->text_len, old_file);
+
+        rec.vnum = b->vnum;
+        rec.id = msg->id;
+        rec.head_len = strlen (msg->head) + 1;
+        rec.text_len = msg->text_len;
+        fwrite (&rec, sizeof (struct board_rec), 1, new_file);
+        fwrite (msg->head, sizeof (char), rec.head_len, new_file);
+        fwrite (text, sizeof (char), rec.text_len, new_file);
+
+        pos += sizeof (struct board_rec) + rec.head_len;
+        new_pos[num++] = pos;
+        pos += rec.text_len;
+      }
+
+  fclose (old_file);
+  if (fclose (new_file) || rename (SAVE_FILE ".new", SAVE_FILE)) {
+    error_log ("Unable to compact savefile..\n\r");
+    free (new_pos);
+    return;
+  }
+
+  num = 0;
+  for (b = board_list; b; b = b->next)
+    for (ind = 0; ind < b->msg_num; ind++)
+      if (b->msg[ind]->pos >= 0)
+        b->msg[ind]->pos = new_pos[num++];
+  free (new_pos);
+  board_junk = 0;
 }
 
+
 void error_log (char *str)
 {                               /* The original error-handling was MUCH */
   fputs ("Board : ", stderr);   /* more competent than the current but  */
@@ -254,76 +481,56 @@ void error_log (char *str)
   return;
 }
 
-int board_display_msg (struct char_data *ch, char *arg)
+
+int board_display_msg (struct char_data *ch, struct board_data *b,
+  char *arg)
 {
-  char buf[512], number[MAX_INPUT_LENGTH], buffer[MAX_STRING_LENGTH];
-  int msg;
+  char number[MAX_INPUT_LENGTH];
+  char buffer[MAX_STRING_LENGTH + MAX_MESSAGE_LENGTH];
+  struct board_msg *msg;
+  FILE *the_file;
+  int ind;
+
   one_argument (arg, number);
   if (!*number || !isdigit ((int)*number))
     return (0);
-  if (!(msg = atoi (number)))
+  if (!(ind = atoi (number)))
     return (0);
-  if (!msg_num) {
+  if (!b->msg_num) {
     send_to_char ("The board is empty!\n\r", ch);
     return (1);
   }
-  if (msg < 1 || msg > msg_num) {
+  if (ind < 1 || ind > b->msg_num) {
     send_to_char ("That message exists only in your imagination..\n\r", ch);
     return (1);
   }
 
-  /*  sprintf(buf, "$n reads message %d titled : %s.",
-     msg, head[msg - 1]);
-     act(buf, TRUE, ch, 0, 0, TO_ROOM);    */
-
-  /* Can PERFORM() handle this...?  no. Sorry */
-  /* sprintf(ch, "Message %d  : %s\n\r%s", msg, head[msg - 1], msgs[msg - 1]); */
-  /* Bad news */
+  msg = b->msg[ind - 1];
+  sprintf (buffer, "Message %d : %s\n\r\n\r", ind, msg->head);
+
+  if (msg->pos < 0)
+    strcat (buffer, "Someone is still writing this one.\n\r");
+  else if (!(the_file = fopen (SAVE_FILE, "rb"))) {
+    error_log ("Unable to open savefile..\n\r");
+    strcat (buffer, "The message has faded away.\n\r");
+  } else {
+    /* the text ends in a '\0', and fits with room to spare */
+    fseek (the_file, msg->pos, 0);
+    fread (buffer + strlen (buffer), sizeof (char), msg->text_len, the_file);
+    fclose (the_file);
+  }
 
-  sprintf (buffer, "Message %d : %s\n\r\n\r%s", msg, head[msg - 1],
-    msgs[msg - 1]);
   page_string (ch->desc, buffer, 1);
   return (1);
 }
 
 
 
-void board_fix_long_desc (int num, char *headers[MAX_MSGS])
-{
-
-  struct obj_data *ob;
-
-
-
-
-  /**** Assign the right value to this pointer..how? ****/
-  /**** It should point to the bulletin board object ****/
-  /**** Then make ob.description point to a malloced ****/
-  /**** space containing itoa(msg_num) and all the   ****/
-  /**** headers. In the format :
-  This is a bulletin board. Usage : READ/REMOVE <message #>, NOTE <header>
-  There are 12 messages on the board.
-  1 : Re : Whatever and something else too.
-  2 : I don't agree with Rainbird.
-  3 : Me neither.
-  4   : Groo got hungry again - bug or sabotage?
-
-  Well...something like that..;)         ****/
-
-  /**** It is always to contain the first line and   ****/
-  /**** the second line will vary in how many notes  ****/
-  /**** the board has. Then the headers and message  ****/
-  /**** numbers will be listed.          ****/
-  return;
-}
-
-
-
-
-int board_show_board (struct char_data *ch, char *arg)
+int board_show_board (struct char_data *ch, struct board_data *b, char *arg)
 {
   int i;
-  char buf[MAX_STRING_LENGTH], tmp[MAX_INPUT_LENGTH];
+  size_t size;
+  char *buf, tmp[MAX_INPUT_LENGTH];
 
   one_argument (arg, tmp);
 
@@ -332,17 +539,24 @@ int board_show_board (struct char_data *ch, char *arg)
 
   act ("$n studies the board.", TRUE, ch, 0, 0, TO_ROOM);
 
+  /* room for every head, however many there are */
+  size = 200;
+  for (i = 0; i < b->msg_num; i++)
+    size += strlen (b->msg[i]->head) + 20;
+  CREATE (buf, char, size);
+
   strcpy (buf,
     "This is a bulletin board. Usage: READ/REMOVE <messg #>, WRITE <header>\n\r");
-  if (!msg_num)
+  if (!b->msg_num)
     strcat (buf, "The board is empty.\n\r");
   else {
     sprintf (buf + strlen (buf), "There are %d messages on the board.\n\r",
-      msg_num);
-    for (i = 0; i < msg_num; i++)
-      sprintf (buf + strlen (buf), "%-2d : %s\n\r", i + 1, head[i]);
+      b->msg_num);
+    for (i = 0; i < b->msg_num; i++)
+      sprintf (buf + strlen (buf), "%-2d : %s\n\r", i + 1, b->msg[i]->head);
   }
   page_string (ch->desc, buf, 1);
+  free (buf);
 
   return (1);
 }
@@ -191,6 +191,85 @@ void do_wizlock (struct char_data *ch, char *argument, int cmd)
   }
 }
 
+void do_reload (struct char_data *ch, char *argument, int cmd)
+{
+  extern struct help_index_element *help_index;
+  extern int top_of_helpt;
+  char buf[MAX_INPUT_LENGTH];
+
+  sprintf (buf, "Help file reloaded by %s.", GET_NAME (ch));
+  log (buf);
+  boot_help ();
+
+  if (help_index)
+    sprintf (buf, "Help reloaded, %d keywords.\n\r", top_of_helpt + 1);
+  else
+    strcpy (buf, "Could not reload the help file, no help available.\n\r");
+  send_to_char (buf, ch);
+}
+
+void do_snapsho (struct char_data *ch, char *argument, int cmd)
+{
+  send_to_char ("If you want a snapshot - say so!\n\r", ch);
+}
+
+void do_snapshot (struct char_data *ch, char *argument, int cmd)
+{
+  char buf[MAX_INPUT_LENGTH];
+
+  sprintf (buf, "Snapshot of the world requested by %s.", GET_NAME (ch));
+  log (buf);
+  snapshot_world (ch);
+}
+
+void do_copyove (struct char_data *ch, char *argument, int cmd)
+{
+  send_to_char ("If you want a copyover - say so!\n\r", ch);
+}
+
+void do_copyover (struct char_data *ch, char *argument, int cmd)
+{
+  copyover (ch);
+  send_to_char ("The copyover failed.\n\r", ch);
+}
+
+/* logging [<part> <level>]: show or set how much each part logs */
+void do_logging (struct char_data *ch, char *argument, int cmd)
+{
+  extern char *log_systems[], *log_levels[];
+  extern int log_level[];
+  char name[MAX_INPUT_LENGTH], level[MAX_INPUT_LENGTH];
+  char buf[MAX_STRING_LENGTH];
+  int system, value;
+
+  argument = one_argument (argument, name);
+  argument = one_argument (argument, level);
+
+  if (!*name) {
+    strcpy (buf, "Logging:\n\r");
+    for (system = 0; system < MAX_LOG; system++)
+      sprintf (buf + strlen (buf), "  %-10s %s\n\r", log_systems[system],
+        log_levels[log_level[system]]);
+    send_to_char (buf, ch);
+    return;
+  }
+
+  if ((system = search_block (name, log_systems, FALSE)) < 0) {
+    send_to_char ("No such part of the game logs.\n\r", ch);
+    return;
+  }
+  if ((value = search_block (level, log_levels, FALSE)) < 0) {
+    send_to_char ("Level must be debug, info, warn, error or off.\n\r", ch);
+    return;
+  }
+
+  log_level[system] = value;
+  sprintf (buf, "%s sets logging of %s to %s.", GET_NAME (ch),
+    log_systems[system], log_levels[value]);
+  log_at (LOG_GAME, LOG_ERROR, buf);
+  send_to_char ("Ok.\n\r", ch);
+}
+
 
 
 
@@ -50,6 +50,13 @@ int no_specials = 0;            /* Suppress ass. of special routines */
 
 int maxdesc, avail_descs;
 int tics = 0;                   /* for extern checkpointing */
+int snapshot_pulses = 0;        /* pulses between world snapshots, 0 = off */
+SOCKET mother_desc = INVALID_SOCKET;    /* where new connections come in */
+SOCKET copyover_mother = INVALID_SOCKET;        /* kept from before a copyover */
+
+char **boot_argv;               /* how we were started, for copyover */
+int boot_argc, boot_opts;
+char boot_path[MAXPATHLEN];     /* argv[0], made absolute */
 
 int get_from_q (struct txt_q *queue, char *dest);
 /* write_to_q is in comm.h for the macro */
@@ -58,6 +65,7 @@ void game_loop (SOCKET s);
 int init_socket (int port);
 int new_connection (SOCKET s);
 int new_descriptor (SOCKET s);
+struct descriptor_data *descriptor_add (SOCKET desc);
 int process_output (struct descriptor_data *t);
 int process_input (struct descriptor_data *t);
 void close_sockets (int s);
@@ -68,6 +76,8 @@ void nonblock (SOCKET s);
 void parse_name (struct descriptor_data *desc, char *arg);
 int load (void);
 void coma (SOCKET s);
+void snapshot_reap (int wait);
+void copyover_recover (void);
 
 
 /* extern fcnts */
@@ -83,6 +93,7 @@ void string_add (struct descriptor_data *d, char *str);
 void perform_violence (void);
 void stop_fighting (struct char_data *ch);
 void show_string (struct descriptor_data *d, char *input);
+void pager_release (struct descriptor_data *d);
 void gr (SOCKET s);
 
 void check_reboot (void);
@@ -100,10 +111,12 @@ int main (int argc, char **argv)
   int port;
   char buf[512];
   int pos = 1;
-  char *dir;
+  char *dir, *log_file = 0, *event_file = 0;
+  unsigned long seed;
 
   port = DFLT_PORT;
   dir = DFLT_DIR;
+  seed = (unsigned long) time (0);
 
   while ((pos < argc) && (*(argv[pos]) == '-')) {
     switch (*(argv[pos] + 1)) {
@@ -125,6 +138,55 @@ int main (int argc, char **argv)
       no_specials = 1;
       log ("Suppressing assignment of special routines.");
       break;
+    case 'r':
+      if (*(argv[pos] + 2))
+        seed = strtoul (argv[pos] + 2, NULL, 10);
+      else if (++pos < argc)
+        seed = strtoul (argv[pos], NULL, 10);
+      else {
+        log ("Seed arg expected after option -r.");
+        exit (0);
+      }
+      break;
+    case 'w':
+      if (*(argv[pos] + 2))
+        snapshot_pulses = atoi (argv[pos] + 2) * 60 * 4;
+      else if (++pos < argc)
+        snapshot_pulses = atoi (argv[pos]) * 60 * 4;
+      else {
+        log ("Minutes arg expected after option -w.");
+        exit (0);
+      }
+      sprintf (buf, "Snapshot of the world every %d minutes.",
+        snapshot_pulses / (60 * 4));
+      log (buf);
+      break;
+    case 'o':
+      if (*(argv[pos] + 2))
+        log_file = argv[pos] + 2;
+      else if (++pos < argc)
+        log_file = argv[pos];
+      else {
+        log ("File arg expected after option -o.");
+        exit (0);
+      }
+      break;
+    case 'e':
+      if (*(argv[pos] + 2))
+        event_file = argv[pos] + 2;
+      else if (++pos < argc)
+        event_file = argv[pos];
+      else {
+        log ("File arg expected after option -e.");
+        exit (0);
+      }
+      break;
+    case 'C':                  /* mother socket, given by copyover() */
+      if (*(argv[pos] + 2))
+        copyover_mother = atoi (argv[pos] + 2);
+      else if (++pos < argc)
+        copyover_mother = atoi (argv[pos]);
+      break;
     default:
       sprintf (buf, "Unknown option -% in argument string.",
         *(argv[pos] + 1));
@@ -134,10 +196,27 @@ int main (int argc, char **argv)
     pos++;
   }
 
+  log_open (log_file);
+  if (event_file)
+    event_open (event_file);
+
+  boot_argv = argv;
+  boot_argc = argc;
+  boot_opts = pos;
+#ifndef WIN32
+  *boot_path = '\0';
+  if (*argv[0] != '/' && strchr (argv[0], '/') &&
+    strlen (argv[0]) + 2 < MAXPATHLEN &&
+    getcwd (boot_path, MAXPATHLEN - strlen (argv[0]) - 2))
+    strcat (boot_path, "/");
+  strcat (boot_path, argv[0]);
+#endif
+
   if (pos < argc)
     if (!isdigit ((int)*argv[pos])) {
-      fprintf (stderr, "Usage: %s [-l] [-s] [-d pathname] [ port # ]\n",
-        argv[0]);
+      fprintf (stderr,
+        "Usage: %s [-l] [-s] [-r seed] [-w minutes] [-o logfile]\n"
+        "       [-e eventfile] [-d pathname] [ port # ]\n", argv[0]);
       exit (0);
     } else if ((port = atoi (argv[pos])) <= 1024) {
       printf ("Illegal port #\n");
@@ -159,7 +238,10 @@ int main (int argc, char **argv)
   sprintf (buf, "Using %s as data directory.", dir);
   log (buf);
 
-  OS_SRAND (time (0));
+  sprintf (buf, "Random seed is %lu.", seed);
+  log (buf);
+  rng_seed (seed);
+
   WIN32STARTUP
   run_the_game (port);
   WIN32CLEANUP
@@ -188,8 +270,14 @@ void run_the_game (int port)
   log ("Signal trapping.");
   signal_setup ();
 
-  log ("Opening mother connection.");
-  s = init_socket (port);
+  if (copyover_mother != INVALID_SOCKET) {
+    log ("Keeping the mother connection from before the copyover.");
+    s = copyover_mother;
+  } else {
+    log ("Opening mother connection.");
+    s = init_socket (port);
+  }
+  mother_desc = s;
 
   if (lawful && load () >= 6) {
     log ("System load too high at startup.");
@@ -198,11 +286,19 @@ void run_the_game (int port)
 
   boot_db ();
 
+  if (copyover_mother != INVALID_SOCKET)
+    copyover_recover ();
+
   log ("Entering game loop.");
 
   game_loop (s);
 
   close_sockets (s);
+  journal_checkpoint ();
+  snapshot_reap (TRUE);
+
+  log ("Saving the world image.");
+  world_save (IMAGE_FILE);
 
   PROFILE (monitor (0);
     )
@@ -234,7 +330,7 @@ void game_loop (SOCKET s)
   static struct timeval opt_time;
   char comm[MAX_INPUT_LENGTH];
   struct descriptor_data *t, *point, *next_point;
-  int pulse = 0;
+  int pulse = 0, snapshot_pulse = 0;
 
   null_time.tv_sec = 0;
   null_time.tv_usec = 0;
@@ -247,6 +343,9 @@ void game_loop (SOCKET s)
   maxdesc = 1;
 #else
   maxdesc = s;
+  for (t = descriptor_list; t; t = t->next)     /* kept by a copyover */
+    if (t->descriptor > maxdesc)
+      maxdesc = t->descriptor;
 #endif
   avail_descs = getdtablesize () - 2;   /* !! Change if more needed !! */
 
@@ -347,7 +446,7 @@ void game_loop (SOCKET s)
         if (point->str)
           string_add (point, comm);
         else if (!point->connected)
-          if (point->showstr_point)
+          if (point->pager)
             show_string (point, comm);
           else
             command_interpreter (point->character, comm);
@@ -372,9 +471,12 @@ void game_loop (SOCKET s)
         if (point->str)
           write_to_descriptor (point->descriptor, "] ");
         else if (!point->connected)
-          if (point->showstr_point)
-            write_to_descriptor (point->descriptor, "*** Press return ***");
-          else
+          if (point->pager) {
+            sprintf (comm, "*** Page %d/%d: Return, B)ack, R)efresh, "
+              "# or Q)uit ***", point->pager->page + 1,
+              (point->pager->num_lines + PAGE_LINES - 1) / PAGE_LINES);
+            write_to_descriptor (point->descriptor, comm);
+          } else
             write_to_descriptor (point->descriptor, "> ");
         point->prompt_mode = 0;
       }
@@ -385,6 +487,7 @@ void game_loop (SOCKET s)
     /* Note: pulse now changes every 1/4 sec  */
 
     pulse++;
+    log_pulse ();
 
     if (!(pulse % PULSE_ZONE)) {
       zone_update ();
@@ -401,6 +504,7 @@ void game_loop (SOCKET s)
 
     if (!(pulse % (SECS_PER_MUD_HOUR * 4))) {
       weather_and_time (1);
+      timer_clock_tick ();
       affect_update ();
       point_update ();
       if (time_info.hours == 1)
@@ -409,11 +513,20 @@ void game_loop (SOCKET s)
 
     if (pulse >= 2400) {
       pulse = 0;
+      journal_checkpoint ();
       if (lawful)
         night_watchman ();
       check_reboot ();
     }
 
+    journal_commit ();          /* sync this pulse's saves */
+
+    if (snapshot_pulses && ++snapshot_pulse >= snapshot_pulses) {
+      snapshot_pulse = 0;
+      snapshot_world (0);
+    }
+    snapshot_reap (FALSE);
+
     tics++;                     /* tics since last checkpoint signal */
   }
 }
@@ -442,7 +555,10 @@ int get_from_q (struct txt_q *queue, char *dest)
   strcpy (dest, queue->head->text);
   queue->head = queue->head->next;
 
-  free (tmp->text);
+  if (tmp->shared)
+    txt_release (tmp->shared);
+  else
+    free (tmp->text);
   free (tmp);
 
   return (1);
@@ -451,24 +567,75 @@ int get_from_q (struct txt_q *queue, char *dest)
 
 
 
+static void txt_enqueue (struct txt_block *new, struct txt_q *queue)
+{
+  new->next = NULL;
+
+  if (!queue->head)
+    queue->head = queue->tail = new;
+  else {
+    queue->tail->next = new;
+    queue->tail = new;
+  }
+}
+
+
 void write_to_q (char *txt, struct txt_q *queue)
+{
+  write_to_q_len (txt, strlen (txt), queue);
+}
+
+
+/* as write_to_q(), for callers that already know the length */
+void write_to_q_len (char *txt, int length, struct txt_q *queue)
 {
   struct txt_block *new;
 
   CREATE (new, struct txt_block, 1);
-  CREATE (new->text, char, strlen (txt) + 1);
+  CREATE (new->text, char, length + 1);
 
-  strcpy (new->text, txt);
+  memcpy (new->text, txt, length + 1);
+  txt_enqueue (new, queue);
+}
 
-  /* Q empty? */
-  if (!queue->head) {
-    new->next = NULL;
-    queue->head = queue->tail = new;
-  } else {
-    queue->tail->next = new;
-    queue->tail = new;
-    new->next = NULL;
-  }
+
+/* Make one copy of a message that many queues can hold.  The caller
+   owns the first reference and drops it with txt_release() once the
+   message has been handed out. */
+struct txt_shared *txt_share (char *txt, int length)
+{
+  struct txt_shared *shared;
+
+  CREATE (shared, struct txt_shared, 1);
+  CREATE (shared->text, char, length + 1);
+
+  memcpy (shared->text, txt, length + 1);
+  shared->refs = 1;
+
+  return (shared);
+}
+
+
+void txt_release (struct txt_shared *shared)
+{
+  if (--shared->refs > 0)
+    return;
+
+  free (shared->text);
+  free (shared);
+}
+
+
+void write_shared_to_q (struct txt_shared *shared, struct txt_q *queue)
+{
+  struct txt_block *new;
+
+  CREATE (new, struct txt_block, 1);
+  new->text = shared->text;
+  new->shared = shared;
+  shared->refs++;
+
+  txt_enqueue (new, queue);
 }
 
 
@@ -499,6 +666,383 @@ struct timeval timediff (struct timeval *a, struct timeval *b)
 
 
 
+/* ******************************************************************
+*  world snapshots                                                   *
+****************************************************************** */
+
+/* A snapshot is written by a forked child from its copy-on-write image
+   of the world, so the game only stands still for the fork itself.    */
+
+#ifndef WIN32
+static pid_t snapshot_pid = 0;  /* child writing a snapshot, if any */
+#endif
+
+
+/* take a snapshot of the world, telling ch (if any) how long the game
+   stood still for it */
+void snapshot_world (struct char_data *ch)
+{
+  struct timeval start, stop, pause;
+  char buf[MAX_STRING_LENGTH];
+  int count;
+
+#ifndef WIN32
+  if (snapshot_pid) {
+    if (ch)
+      send_to_char ("A snapshot is still being written.\n\r", ch);
+    return;
+  }
+
+  gettimeofday (&start, NULL);
+  if ((snapshot_pid = fork ()) == 0) {
+    log_child ();
+    gettimeofday (&start, NULL);
+    count = world_save (IMAGE_FILE);
+    gettimeofday (&stop, NULL);
+    pause = timediff (&stop, &start);
+    if (count >= 0) {
+      sprintf (buf, "Snapshot of %d objects written in %ld.%06ld sec.",
+        count, (long) pause.tv_sec, (long) pause.tv_usec);
+      log_at (LOG_SAVE, LOG_INFO, buf);
+    }
+    _exit (count < 0);          /* leave the parent's stdio buffers alone */
+  }
+  gettimeofday (&stop, NULL);
+
+  if (snapshot_pid < 0) {
+    perror ("snapshot_world: fork");
+    snapshot_pid = 0;
+    if (ch)
+      send_to_char ("Could not start a snapshot.\n\r", ch);
+    return;
+  }
+  pause = timediff (&stop, &start);
+  sprintf (buf, "Snapshot started; the game stood still for %ld usec.",
+    (long) pause.tv_sec * 1000000L + (long) pause.tv_usec);
+#else
+  /* no fork here, so the game waits for the whole save */
+  gettimeofday (&start, NULL);
+  count = world_save (IMAGE_FILE);
+  gettimeofday (&stop, NULL);
+  pause = timediff (&stop, &start);
+  sprintf (buf, "Snapshot of %d objects; the game stood still for %ld usec.",
+    count, (long) pause.tv_sec * 1000000L + (long) pause.tv_usec);
+#endif
+
+  log_at (LOG_SAVE, LOG_INFO, buf);
+  if (ch) {
+    strcat (buf, "\n\r");
+    send_to_char (buf, ch);
+  }
+}
+
+
+/* collect a finished snapshot child, waiting for it if wait is set */
+void snapshot_reap (int wait)
+{
+#ifndef WIN32
+  int status;
+
+  if (snapshot_pid &&
+    waitpid (snapshot_pid, &status, wait ? 0 : WNOHANG) == snapshot_pid) {
+    if (!WIFEXITED (status) || WEXITSTATUS (status))
+      log ("Snapshot of the world failed.");
+    snapshot_pid = 0;
+  }
+#endif
+}
+
+
+
+
+
+
+/* ******************************************************************
+*  copyover                                                          *
+****************************************************************** */
+
+/* A copyover starts the game binary again in place of this one.  The
+   mother connection and the sockets of the players are kept open over
+   the exec(), and the copyover file tells the new game who was on
+   which socket, where they stood and what they had with them.  Link
+   dead players come along too.  The world comes back from the world
+   image, so nothing is reset.                                        */
+
+#define COPYOVER_MAGIC 0x434f5059L
+
+struct copyover_head {
+  long magic;
+  long start_sec;               /* when the copyover began */
+  long start_usec;
+  int num_players;
+};
+
+struct copyover_player {
+  SOCKET desc;                  /* INVALID_SOCKET if link dead */
+  char host[50];
+  char name[20];
+  sh_int room;                  /* virtual number */
+  int num_objs;                 /* world_obj_u records that follow */
+};
+
+
+/* run a new copy of the game on the same sockets; only returns if that
+   could not be done, with the game going on as before */
+void copyover (struct char_data *ch)
+{
+#ifndef WIN32
+  struct copyover_head head;
+  struct copyover_player pl;
+  struct char_file_u st;
+  struct descriptor_data *d, *next_d;
+  struct char_data *i;
+  struct timeval start;
+  char buf[MAX_STRING_LENGTH], mother[20], pwd[12], **args;
+  FILE *fl;
+  long pos;
+  int arg, n, fd, ok, player_i;
+
+  extern struct char_data *character_list;
+  extern struct player_index_element *player_table;
+  extern char log_path[], event_path[];
+  void do_return (struct char_data *ch, char *argument, int cmd);
+  int load_char (char *name, struct char_file_u *char_element);
+  void char_to_store (struct char_data *ch, struct char_file_u *st);
+
+  gettimeofday (&start, NULL);
+
+  if (!(fl = fopen (COPYOVER_FILE, "wb"))) {
+    perror ("copyover");
+    if (ch)
+      send_to_char ("Could not write the copyover file.\n\r", ch);
+    return;
+  }
+
+  sprintf (buf, "Copyover by %s.", ch ? GET_NAME (ch) : "the nightly reboot");
+  log (buf);
+
+  /* those still logging in have to come back */
+  for (d = descriptor_list; d; d = next_d) {
+    next_d = d->next;
+    if (d->original)
+      do_return (d->character, "", 0);
+    if (d->connected != CON_PLYNG || !d->character) {
+      write_to_descriptor (d->descriptor,
+        "\n\rThe game is rebooting, please come back in a moment.\n\r");
+      close_socket (d);
+    } else
+      process_output (d);
+  }
+
+  memset (&head, 0, sizeof (head));
+  head.magic = COPYOVER_MAGIC;
+  head.start_sec = start.tv_sec;
+  head.start_usec = start.tv_usec;
+  ok = fwrite (&head, sizeof (head), 1, fl) == 1;
+
+  for (i = character_list; ok && i; i = i->next)
+    if (!IS_NPC (i) && i->in_room != NOWHERE) {
+      memset (&pl, 0, sizeof (pl));
+      pl.desc = i->desc ? i->desc->descriptor : INVALID_SOCKET;
+      if (i->desc)
+        strcpy (pl.host, i->desc->host);
+      strncpy (pl.name, GET_NAME (i), sizeof (pl.name) - 1);
+      pl.room = world[i->in_room].number;
+      if (i->desc)
+        save_char (i, NOWHERE);
+      else if ((player_i = load_char (GET_NAME (i), &st)) >= 0) {
+        /* save_char needs a descriptor; the password of one link dead
+           is only in the player file */
+        strcpy (pwd, st.pwd);
+        char_to_store (i, &st);
+        st.load_room = NOWHERE;
+        strcpy (st.pwd, pwd);
+        journal_write (JOURNAL_PLAYERS,
+          player_table[player_i].nr * sizeof (struct char_file_u),
+          &st, sizeof (struct char_file_u));
+      }
+
+      pos = ftell (fl);
+      if (!(ok = fwrite (&pl, sizeof (pl), 1, fl) == 1) ||
+        !(ok = (n = world_save_objs (fl, i)) >= 0))
+        break;
+      pl.num_objs = n;
+      fseek (fl, pos, 0);
+      ok = fwrite (&pl, sizeof (pl), 1, fl) == 1;
+      fseek (fl, 0L, 2);
+      head.num_players++;
+    }
+
+  if (ok) {
+    fseek (fl, 0L, 0);
+    ok = fwrite (&head, sizeof (head), 1, fl) == 1;
+  }
+  if (fclose (fl) || !ok) {
+    perror ("copyover");
+    unlink (COPYOVER_FILE);
+    if (ch)
+      send_to_char ("Could not write the copyover file.\n\r", ch);
+    return;
+  }
+
+  journal_checkpoint ();
+  snapshot_reap (TRUE);
+  log ("Saving the world image.");
+  world_save (IMAGE_FILE);
+
+  for (d = descriptor_list; d; d = d->next)
+    write_to_descriptor (d->descriptor, "\n\rTime stops for a moment...\n\r");
+
+  /* the game as it was started, on the mother socket we have, from the
+     data directory we are in */
+  CREATE (args, char *, boot_argc + 10);
+  n = 0;
+  args[n++] = boot_path;
+  for (arg = 1; arg < boot_opts; arg++)
+    if (boot_argv[arg][0] == '-' &&
+      (boot_argv[arg][1] == 'C' || boot_argv[arg][1] == 'd' ||
+        boot_argv[arg][1] == 'o' || boot_argv[arg][1] == 'e')) {
+      if (!boot_argv[arg][2])
+        arg++;
+    } else
+      args[n++] = boot_argv[arg];
+  sprintf (mother, "%d", mother_desc);
+  args[n++] = "-C";
+  args[n++] = mother;
+  args[n++] = "-d";
+  args[n++] = ".";
+  if (*log_path) {
+    args[n++] = "-o";
+    args[n++] = log_path;
+  }
+  if (*event_path) {
+    args[n++] = "-e";
+    args[n++] = event_path;
+  }
+  for (arg = boot_opts; arg < boot_argc; arg++)
+    args[n++] = boot_argv[arg];
+  args[n] = 0;
+
+  /* nothing but the sockets goes over to the new game */
+  for (fd = 3; fd < avail_descs + 2; fd++)
+    if (fd != mother_desc)
+      fcntl (fd, F_SETFD, FD_CLOEXEC);
+  for (d = descriptor_list; d; d = d->next)
+    fcntl (d->descriptor, F_SETFD, 0);
+  log_flush ();
+  fflush (NULL);
+
+  execvp (boot_path, args);
+
+  /* still here, so carry on */
+  perror ("copyover: exec");
+  for (fd = 3; fd < avail_descs + 2; fd++)
+    fcntl (fd, F_SETFD, 0);
+  free (args);
+  unlink (COPYOVER_FILE);
+  send_to_all ("The reboot failed; the game goes on.\n\r");
+#else
+  if (ch)
+    send_to_char ("There is no copyover on this system.\n\r", ch);
+#endif
+}
+
+
+/* take back the players of the game before the copyover */
+void copyover_recover (void)
+{
+#ifndef WIN32
+  struct copyover_head head;
+  struct copyover_player pl;
+  struct char_file_u st;
+  struct descriptor_data *d;
+  struct char_data *ch;
+  struct timeval now, start, down;
+  char buf[MAX_STRING_LENGTH];
+  FILE *fl;
+  int i, player_i, room, count = 0;
+
+  extern struct char_data *character_list;
+  extern struct player_index_element *player_table;
+  void do_look (struct char_data *ch, char *argument, int cmd);
+  int load_char (char *name, struct char_file_u *char_element);
+  void store_to_char (struct char_file_u *st, struct char_data *ch);
+
+  log ("Taking back the players from before the copyover.");
+
+  if (!(fl = fopen (COPYOVER_FILE, "rb"))) {
+    perror ("copyover_recover");
+    return;
+  }
+  unlink (COPYOVER_FILE);
+
+  if (fread (&head, sizeof (head), 1, fl) < 1 || head.magic != COPYOVER_MAGIC) {
+    log ("   The copyover file is damaged.");
+    fclose (fl);
+    return;
+  }
+
+  for (i = 0; i < head.num_players; i++) {
+    if (fread (&pl, sizeof (pl), 1, fl) < 1)
+      break;
+    pl.name[sizeof (pl.name) - 1] = '\0';
+
+    if ((player_i = load_char (pl.name, &st)) < 0) {
+      if (pl.desc != INVALID_SOCKET) {
+        write_to_descriptor (pl.desc,
+          "\n\rYour character was lost in the reboot, sorry.\n\r");
+        close (pl.desc);
+      }
+      fseek (fl, pl.num_objs * (long) sizeof (struct world_obj_u), 1);
+      continue;
+    }
+
+    CREATE (ch, struct char_data, 1);
+    clear_char (ch);
+    store_to_char (&st, ch);
+    reset_char (ch);
+    ch->next = character_list;
+    character_list = ch;
+    affect_timers_start (ch);
+
+    if ((room = real_room (pl.room)) < 0)
+      room = real_room (3001);
+    char_to_room (ch, room);
+
+    if (!world_load_objs (fl, ch, pl.num_objs))
+      log ("   The copyover file is cut short.");
+
+    if (pl.desc != INVALID_SOCKET) {
+      d = descriptor_add (pl.desc);
+      strcpy (d->host, pl.host);
+      strcpy (d->pwd, st.pwd);
+      d->pos = player_table[player_i].nr;
+      d->character = ch;
+      d->connected = CON_PLYNG;
+      ch->desc = d;
+      SEND_TO_Q ("Time resumes.\n\r", d);
+      do_look (ch, "", 15);
+      d->prompt_mode = 1;
+    }
+    count++;
+  }
+  fclose (fl);
+
+  gettimeofday (&now, NULL);
+  start.tv_sec = head.start_sec;
+  start.tv_usec = head.start_usec;
+  down = timediff (&now, &start);
+  sprintf (buf, "   %d players back; the game was down for %ld msec.", count,
+    (long) down.tv_sec * 1000L + (long) down.tv_usec / 1000L);
+  log (buf);
+#endif
+}
+
+
+
+
+
+
 /* Empty the queues before closing connection */
 void flush_queues (struct descriptor_data *d)
 {
@@ -614,6 +1158,42 @@ int new_connection (SOCKET s)
 
 
 
+/* make a descriptor for the socket desc and put it on the list */
+struct descriptor_data *descriptor_add (SOCKET desc)
+{
+  struct descriptor_data *newd;
+
+  CREATE (newd, struct descriptor_data, 1);
+
+  /* init desc data */
+  newd->descriptor = desc;
+  newd->connected = 1;
+  newd->wait = 1;
+  newd->prompt_mode = 0;
+  *newd->buf = '\0';
+  newd->str = 0;
+  newd->str_keywords = 0;
+  newd->str_done = 0;
+  newd->pager = 0;
+  *newd->last_input = '\0';
+  newd->output.head = NULL;
+  newd->input.head = NULL;
+  newd->next = descriptor_list;
+  newd->character = 0;
+  newd->original = 0;
+  newd->snoop.snooping = 0;
+  newd->snoop.snoop_by = 0;
+
+  /* prepend to list */
+
+  descriptor_list = newd;
+
+  return (newd);
+}
+
+
+
+
 int new_descriptor (SOCKET s)
 {
   int desc;
@@ -652,7 +1232,7 @@ int new_descriptor (SOCKET s)
     maxdesc = desc;
 #endif
 
-  CREATE (newd, struct descriptor_data, 1);
+  newd = descriptor_add (desc);
 
   /* find info */
   size = sizeof (sock);
@@ -667,29 +1247,6 @@ int new_descriptor (SOCKET s)
     *(newd->host + 49) = '\0';
   }
 
-
-  /* init desc data */
-  newd->descriptor = desc;
-  newd->connected = 1;
-  newd->wait = 1;
-  newd->prompt_mode = 0;
-  *newd->buf = '\0';
-  newd->str = 0;
-  newd->showstr_head = 0;
-  newd->showstr_point = 0;
-  *newd->last_input = '\0';
-  newd->output.head = NULL;
-  newd->input.head = NULL;
-  newd->next = descriptor_list;
-  newd->character = 0;
-  newd->original = 0;
-  newd->snoop.snooping = 0;
-  newd->snoop.snoop_by = 0;
-
-  /* prepend to list */
-
-  descriptor_list = newd;
-
   SEND_TO_Q (GREETINGS, newd);
   SEND_TO_Q ("By what name do you wish to be known? ", newd);
 
@@ -883,20 +1440,24 @@ void close_socket (struct descriptor_data *d)
     d->snoop.snoop_by->desc->snoop.snooping = 0;
   }
 
+  /* Keep what had been written so far */
+  if (d->str && d->str_done)
+    (*d->str_done) (d->str);
+
   if (d->character)
     if (d->connected == CON_PLYNG) {
       save_char (d->character, NOWHERE);
       act ("$n has lost $s link.", TRUE, d->character, 0, 0, TO_ROOM);
       sprintf (buf, "Closing link to: %s.", GET_NAME (d->character));
-      log (buf);
+      log_at (LOG_CONNECT, LOG_INFO, buf);
       d->character->desc = 0;
     } else {
       sprintf (buf, "Losing player: %s.", GET_NAME (d->character));
-      log (buf);
+      log_at (LOG_CONNECT, LOG_INFO, buf);
 
       free_char (d->character);
   } else
-    log ("Losing descriptor without char.");
+    log_at (LOG_CONNECT, LOG_INFO, "Losing descriptor without char.");
 
 
   if (next_to_process == d)     /* to avoid crashing the process loop */
@@ -911,8 +1472,8 @@ void close_socket (struct descriptor_data *d)
 
     tmp->next = d->next;
   }
-  if (d->showstr_head)
-    free (d->showstr_head);
+  if (d->pager)
+    pager_release (d);
   free (d);
 }
 
@@ -1027,34 +1588,46 @@ void send_to_char (char *messg, struct char_data *ch)
 void send_to_all (char *messg)
 {
   struct descriptor_data *i;
+  struct txt_shared *shared;
 
-  if (messg)
+  if (messg) {
+    shared = txt_share (messg, strlen (messg));
     for (i = descriptor_list; i; i = i->next)
       if (!i->connected)
-        write_to_q (messg, &i->output);
+        write_shared_to_q (shared, &i->output);
+    txt_release (shared);
+  }
 }
 
 
 void send_to_outdoor (char *messg)
 {
   struct descriptor_data *i;
+  struct txt_shared *shared;
 
-  if (messg)
+  if (messg) {
+    shared = txt_share (messg, strlen (messg));
     for (i = descriptor_list; i; i = i->next)
       if (!i->connected)
         if (OUTSIDE (i->character))
-          write_to_q (messg, &i->output);
+          write_shared_to_q (shared, &i->output);
+    txt_release (shared);
+  }
 }
 
 
 void send_to_except (char *messg, struct char_data *ch)
 {
   struct descriptor_data *i;
+  struct txt_shared *shared;
 
-  if (messg)
+  if (messg) {
+    shared = txt_share (messg, strlen (messg));
     for (i = descriptor_list; i; i = i->next)
       if (ch->desc != i && !i->connected)
-        write_to_q (messg, &i->output);
+        write_shared_to_q (shared, &i->output);
+    txt_release (shared);
+  }
 }
 
 
@@ -1062,11 +1635,15 @@ void send_to_except (char *messg, struct char_data *ch)
 void send_to_room (char *messg, int room)
 {
   struct char_data *i;
+  struct txt_shared *shared;
 
-  if (messg)
+  if (messg) {
+    shared = txt_share (messg, strlen (messg));
     for (i = world[room].people; i; i = i->next_in_room)
       if (i->desc)
-        write_to_q (messg, &i->desc->output);
+        write_shared_to_q (shared, &i->desc->output);
+    txt_release (shared);
+  }
 }
 
 
@@ -1075,21 +1652,29 @@ void send_to_room (char *messg, int room)
 void send_to_room_except (char *messg, int room, struct char_data *ch)
 {
   struct char_data *i;
+  struct txt_shared *shared;
 
-  if (messg)
+  if (messg) {
+    shared = txt_share (messg, strlen (messg));
     for (i = world[room].people; i; i = i->next_in_room)
       if (i != ch && i->desc)
-        write_to_q (messg, &i->desc->output);
+        write_shared_to_q (shared, &i->desc->output);
+    txt_release (shared);
+  }
 }
 
 void send_to_room_except_two
   (char *messg, int room, struct char_data *ch1, struct char_data *ch2) {
   struct char_data *i;
+  struct txt_shared *shared;
 
-  if (messg)
+  if (messg) {
+    shared = txt_share (messg, strlen (messg));
     for (i = world[room].people; i; i = i->next_in_room)
       if (i != ch1 && i != ch2 && i->desc)
-        write_to_q (messg, &i->desc->output);
+        write_shared_to_q (shared, &i->desc->output);
+    txt_release (shared);
+  }
 }
 
 
@@ -1097,17 +1682,248 @@ void send_to_room_except_two
 /* higher-level communication */
 
 
-void act (char *str, int hide_invisible, struct char_data *ch,
-  struct obj_data *obj, void *vict_obj, int type)
+/* act() templates are compiled once into runs of literal text and
+   $-codes, and kept in a small cache keyed by the format pointer.  Most
+   formats are string constants; the source text is kept alongside so a
+   reused sprintf() buffer is noticed and simply compiled again. */
+
+#define ACT_CACHE_SIZE  512
+
+/* which of the things named in a message the recipient can see */
+#define ACT_SEES_CH    1        /* $n, and hide_invisible */
+#define ACT_SEES_VICT  2        /* $N */
+#define ACT_SEES_OBJ   4        /* $o $p */
+#define ACT_SEES_VOBJ  8        /* $O $P */
+#define ACT_CLASSES   16
+
+struct act_segment {
+  char code;                    /* 0 for literal text */
+  int length;                   /* of literal text */
+  char *text;
+};
+
+struct act_template {
+  char *key;                    /* format pointer given to act() */
+  char *source;                 /* copy of the format it was compiled from */
+  int sees;                     /* ACT_SEES_ bits the output depends on */
+  int num_segments;
+  int max_segments;             /* room in segment[] */
+  struct act_segment *segment;
+};
+
+static struct act_template act_cache[ACT_CACHE_SIZE];
+
+
+static void act_compile (struct act_template *tp, char *str)
 {
-  register char *strp, *point, *i = NULL;
-  struct char_data *to;
-  char buf[MAX_STRING_LENGTH];
+  struct act_segment *seg;
+  char *strp, *start;
+  int codes;
+
+  if (tp->source)
+    free (tp->source);
+
+  /* each $-code is at most itself and the text before it, and there
+     may be text after the last one */
+  for (codes = 0, strp = str; *strp; strp++)
+    if (*strp == '$' && *(strp + 1)) {
+      codes++;
+      strp++;
+    }
+  if (tp->max_segments < 2 * codes + 1) {
+    tp->max_segments = 2 * codes + 1;
+    RECREATE (tp->segment, struct act_segment, tp->max_segments);
+  }
 
-  if (!str)
-    return;
-  if (!*str)
-    return;
+  tp->key = str;
+  CREATE (tp->source, char, strlen (str) + 1);
+  strcpy (tp->source, str);
+  tp->sees = 0;
+  tp->num_segments = 0;
+
+  for (strp = start = tp->source; *strp;) {
+    if (*strp != '$' || !*(strp + 1)) {
+      strp++;
+      continue;
+    }
+
+    if (strp > start) {
+      seg = &tp->segment[tp->num_segments++];
+      seg->code = 0;
+      seg->text = start;
+      seg->length = strp - start;
+    }
+
+    seg = &tp->segment[tp->num_segments++];
+    seg->code = *(++strp);
+    seg->text = 0;
+    seg->length = 0;
+
+    switch (seg->code) {
+    case 'n':
+      tp->sees |= ACT_SEES_CH;
+      break;
+    case 'N':
+      tp->sees |= ACT_SEES_VICT;
+      break;
+    case 'o':
+    case 'p':
+      tp->sees |= ACT_SEES_OBJ;
+      break;
+    case 'O':
+    case 'P':
+      tp->sees |= ACT_SEES_VOBJ;
+      break;
+    case 'm': case 'M': case 's': case 'S': case 'e': case 'E':
+    case 'a': case 'A': case 'T': case 'F': case '$':
+      break;
+    default:
+      log ("Illegal $-code to act():");
+      log (str);
+      tp->num_segments--;
+      break;
+    }
+
+    start = ++strp;
+  }
+
+  if (*start) {
+    seg = &tp->segment[tp->num_segments++];
+    seg->code = 0;
+    seg->text = start;
+    seg->length = strlen (start);
+  }
+}
+
+
+static struct act_template *act_template (char *str)
+{
+  struct act_template *tp;
+
+  tp = &act_cache[((unsigned long) str >> 2) % ACT_CACHE_SIZE];
+
+  if (tp->key != str || strcmp (tp->source, str))
+    act_compile (tp, str);
+
+  return (tp);
+}
+
+
+/* render a template as seen by recipients of one visibility class */
+static int act_render (struct act_template *tp, int sees, char *buf,
+  struct char_data *ch, struct obj_data *obj, void *vict_obj)
+{
+  struct act_segment *seg;
+  struct char_data *vict = (struct char_data *) vict_obj;
+  struct obj_data *vobj = (struct obj_data *) vict_obj;
+  char *point = buf, *end = buf + MAX_STRING_LENGTH - 3, *i;
+  int n;
+
+  for (seg = tp->segment; seg < tp->segment + tp->num_segments; seg++) {
+    if (!seg->code) {
+      n = MIN (seg->length, end - point);
+      memcpy (point, seg->text, n);
+      point += n;
+      continue;
+    }
+
+    switch (seg->code) {
+    case 'n':
+      i = (sees & ACT_SEES_CH) ?
+        (!IS_NPC (ch) ? ch->player.name : ch->player.short_descr) : "someone";
+      break;
+    case 'N':
+      i = (sees & ACT_SEES_VICT) ?
+        (!IS_NPC (vict) ? vict->player.name : vict->player.short_descr) :
+        "someone";
+      break;
+    case 'm':
+      i = HMHR (ch);
+      break;
+    case 'M':
+      i = HMHR (vict);
+      break;
+    case 's':
+      i = HSHR (ch);
+      break;
+    case 'S':
+      i = HSHR (vict);
+      break;
+    case 'e':
+      i = HSSH (ch);
+      break;
+    case 'E':
+      i = HSSH (vict);
+      break;
+    case 'o':
+      i = (sees & ACT_SEES_OBJ) ? fname (obj->name) : "something";
+      break;
+    case 'O':
+      i = (sees & ACT_SEES_VOBJ) ? fname (vobj->name) : "something";
+      break;
+    case 'p':
+      i = (sees & ACT_SEES_OBJ) ? obj->short_description : "something";
+      break;
+    case 'P':
+      i = (sees & ACT_SEES_VOBJ) ? vobj->short_description : "something";
+      break;
+    case 'a':
+      i = SANA (obj);
+      break;
+    case 'A':
+      i = SANA (vobj);
+      break;
+    case 'T':
+      i = (char *) vict_obj;
+      break;
+    case 'F':
+      i = fname ((char *) vict_obj);
+      break;
+    default:                   /* '$' */
+      i = "$";
+      break;
+    }
+
+    while (*i && point < end)
+      *(point++) = *(i++);
+  }
+
+  *(point++) = '\n';
+  *(point++) = '\r';
+  *point = '\0';
+
+  CAP (buf);
+
+  return (point - buf);
+}
+
+
+/* Compile a format that will be used for the life of the game, such as
+   a social message read at boot.  The template is not kept in the cache,
+   so it never has to be compiled again. */
+struct act_template *act_prepare (char *str)
+{
+  struct act_template *tp;
+
+  if (!str || !*str)
+    return (0);
+
+  CREATE (tp, struct act_template, 1);
+  act_compile (tp, str);
+
+  return (tp);
+}
+
+
+/* send a template to the recipients given by type; if tp is 0 str is
+   looked up in the cache, but only once someone is found to hear it */
+static void act_send (char *str, struct act_template *tp, int hide_invisible,
+  struct char_data *ch, struct obj_data *obj, void *vict_obj, int type)
+{
+  static char buf[ACT_CLASSES][MAX_STRING_LENGTH];
+  int length[ACT_CLASSES];
+  struct char_data *to;
+  int sees;
 
   if (type == TO_VICT)
     to = (struct char_data *) vict_obj;
@@ -1116,80 +1932,36 @@ void act (char *str, int hide_invisible, struct char_data *ch,
   else
     to = world[ch->in_room].people;
 
+  length[0] = -2;
+
   for (; to; to = to->next_in_room) {
     if (to->desc && ((to != ch) || (type == TO_CHAR)) &&
       (CAN_SEE (to, ch) || !hide_invisible) && AWAKE (to) &&
       !((type == TO_NOTVICT) && (to == (struct char_data *) vict_obj))) {
-      for (strp = str, point = buf;;)
-        if (*strp == '$') {
-          switch (*(++strp)) {
-          case 'n':
-            i = PERS (ch, to);
-            break;
-          case 'N':
-            i = PERS ((struct char_data *) vict_obj, to);
-            break;
-          case 'm':
-            i = HMHR (ch);
-            break;
-          case 'M':
-            i = HMHR ((struct char_data *) vict_obj);
-            break;
-          case 's':
-            i = HSHR (ch);
-            break;
-          case 'S':
-            i = HSHR ((struct char_data *) vict_obj);
-            break;
-          case 'e':
-            i = HSSH (ch);
-            break;
-          case 'E':
-            i = HSSH ((struct char_data *) vict_obj);
-            break;
-          case 'o':
-            i = OBJN (obj, to);
-            break;
-          case 'O':
-            i = OBJN ((struct obj_data *) vict_obj, to);
-            break;
-          case 'p':
-            i = OBJS (obj, to);
-            break;
-          case 'P':
-            i = OBJS ((struct obj_data *) vict_obj, to);
-            break;
-          case 'a':
-            i = SANA (obj);
-            break;
-          case 'A':
-            i = SANA ((struct obj_data *) vict_obj);
-            break;
-          case 'T':
-            i = (char *) vict_obj;
-            break;
-          case 'F':
-            i = fname ((char *) vict_obj);
-            break;
-          case '$':
-            i = "$";
-            break;
-          default:
-            log ("Illegal $-code to act():");
-            log (str);
-            break;
-          }
-          while (*point = *(i++))
-            ++point;
-          ++strp;
-        } else if (!(*(point++) = *(strp++)))
-          break;
-
-      *(--point) = '\n';
-      *(++point) = '\r';
-      *(++point) = '\0';
+      if (length[0] == -2) {
+        if (!tp)
+          tp = act_template (str);
+        for (sees = 0; sees < ACT_CLASSES; sees++)
+          length[sees] = -1;
+      }
 
-      write_to_q (CAP (buf), &to->desc->output);
+      /* recipients who see the same things get the same text */
+      sees = 0;
+      if ((tp->sees & ACT_SEES_CH) && CAN_SEE (to, ch))
+        sees |= ACT_SEES_CH;
+      if ((tp->sees & ACT_SEES_VICT) &&
+        CAN_SEE (to, (struct char_data *) vict_obj))
+        sees |= ACT_SEES_VICT;
+      if ((tp->sees & ACT_SEES_OBJ) && CAN_SEE_OBJ (to, obj))
+        sees |= ACT_SEES_OBJ;
+      if ((tp->sees & ACT_SEES_VOBJ) &&
+        CAN_SEE_OBJ (to, (struct obj_data *) vict_obj))
+        sees |= ACT_SEES_VOBJ;
+
+      if (length[sees] < 0)
+        length[sees] = act_render (tp, sees, buf[sees], ch, obj, vict_obj);
+
+      write_to_q_len (buf[sees], length[sees], &to->desc->output);
     }
     if ((type == TO_VICT) || (type == TO_CHAR))
       return;
@@ -1197,3 +1969,69 @@ void act (char *str, int hide_invisible, struct char_data *ch,
 }
 
 
+void act (char *str, int hide_invisible, struct char_data *ch,
+  struct obj_data *obj, void *vict_obj, int type)
+{
+  if (!str)
+    return;
+  if (!*str)
+    return;
+
+  act_send (str, 0, hide_invisible, ch, obj, vict_obj, type);
+}
+
+
+/* act() with a template from act_prepare() */
+void act_prepared (struct act_template *tp, int hide_invisible,
+  struct char_data *ch, struct obj_data *obj, void *vict_obj, int type)
+{
+  if (!tp)
+    return;
+
+  act_send (0, tp, hide_invisible, ch, obj, vict_obj, type);
+}
+
+
+/* Send an act() style message about ch to every playing character but
+   ch, for shouts and the like.  Only $-codes about ch itself may be used.
+   The text is rendered at most twice -- for those who can see ch and
+   for those who cannot -- and every recipient's queue shares the copy. */
+void broadcast (char *str, struct char_data *ch, int flags)
+{
+  static char buf[MAX_STRING_LENGTH];
+  struct txt_shared *shared[2];
+  struct act_template *tp;
+  struct descriptor_data *i;
+  struct char_data *to;
+  int sees;
+
+  if (!str || !*str)
+    return;
+
+  tp = act_template (str);
+  shared[0] = shared[1] = 0;
+
+  for (i = descriptor_list; i; i = i->next) {
+    to = i->character;
+    if (i->connected || to == ch)
+      continue;
+    if ((flags & BCAST_AWAKE) && !AWAKE (to))
+      continue;
+    if ((flags & BCAST_SHOUT) && IS_SET (to->specials.act, PLR_NOSHOUT))
+      continue;
+    if ((flags & BCAST_OUTDOOR) && !OUTSIDE (to))
+      continue;
+
+    sees = ((tp->sees & ACT_SEES_CH) && CAN_SEE (to, ch)) ? ACT_SEES_CH : 0;
+    if (!shared[sees])
+      shared[sees] = txt_share (buf, act_render (tp, sees, buf, ch, 0, 0));
+
+    write_shared_to_q (shared[sees], &i->output);
+  }
+
+  for (sees = 0; sees < 2; sees++)
+    if (shared[sees])
+      txt_release (shared[sees]);
+}
+
+
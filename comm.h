@@ -11,21 +11,36 @@ extern void send_to_room_except (char *messg, int room, struct char_data *ch);
 extern void send_to_room_except_two
   (char *messg, int room, struct char_data *ch1, struct char_data *ch2);
 extern void send_to_outdoor (char *messg);
+extern void broadcast (char *str, struct char_data *ch, int flags);
 extern void perform_to_all (char *messg, struct char_data *ch);
 extern void perform_complex (struct char_data *ch1, struct char_data *ch2,
   struct obj_data *obj1, struct obj_data *obj2,
   char *mess, byte mess_type, bool hide);
 extern void close_socket (struct descriptor_data *d);
+extern void snapshot_world (struct char_data *ch);
+extern void copyover (struct char_data *ch);
 
 extern void act (char *str, int hide_invisible, struct char_data *ch,
   struct obj_data *obj, void *vict_obj, int type);
+extern struct act_template *act_prepare (char *str);
+extern void act_prepared (struct act_template *tp, int hide_invisible,
+  struct char_data *ch, struct obj_data *obj, void *vict_obj, int type);
 
 #define TO_ROOM    0
 #define TO_VICT    1
 #define TO_NOTVICT 2
 #define TO_CHAR    3
 
+/* broadcast() always skips ch and anyone not playing; these narrow it */
+#define BCAST_AWAKE   1         /* only characters that are awake */
+#define BCAST_SHOUT   2         /* not characters with PLR_NOSHOUT */
+#define BCAST_OUTDOOR 4         /* only characters outdoors */
+
 extern int write_to_descriptor (int desc, char *txt);
 extern void write_to_q (char *txt, struct txt_q *queue);
+extern void write_to_q_len (char *txt, int length, struct txt_q *queue);
+extern struct txt_shared *txt_share (char *txt, int length);
+extern void txt_release (struct txt_shared *shared);
+extern void write_shared_to_q (struct txt_shared *shared, struct txt_q *queue);
 #define SEND_TO_Q(messg, desc)  write_to_q((messg), &(desc)->output)
 
@@ -41,8 +41,7 @@ char wizlist[MAX_STRING_LENGTH];        /* the wizlist                     */
 
 
 FILE *mob_f,                    /* file containing mob prototypes  */
- *obj_f,                        /* obj prototypes                  */
- *help_fl;                      /* file for help texts (HELP <kwd>) */
+ *obj_f;                        /* obj prototypes                  */
 
 struct index_data *mob_index;   /* index table for mobile file     */
 struct index_data *obj_index;   /* index table for object file     */
@@ -73,11 +72,13 @@ int is_empty (int zone_nr);
 void reset_zone (int zone);
 int file_to_string (char *name, char *buf);
 void renum_world (void);
+void link_zones (void);
 void renum_zone_table (void);
 void reset_time (void);
 void clear_char (struct char_data *ch);
 
 /* external refs */
+char *str_dup (char *source);
 extern struct descriptor_data *descriptor_list;
 void load_messages (void);
 void weather_and_time (int mode);
@@ -88,7 +89,6 @@ int number (int from, int to);
 void boot_social_messages (void);
 void boot_pose_messages (void);
 void update_obj_file (void);    /* In reception.c */
-struct help_index_element *build_help_index (FILE * fl, int *num);
 
 
 /*************************************************************************
@@ -100,6 +100,7 @@ struct help_index_element *build_help_index (FILE * fl, int *num);
 void boot_db (void)
 {
   int i;
+  char buf[MAX_STRING_LENGTH];
   extern int no_specials;
 
   log ("Boot db -- BEGIN.");
@@ -107,6 +108,9 @@ void boot_db (void)
   log ("Resetting the game time:");
   reset_time ();
 
+  log ("Replaying the save journal.");
+  journal_replay ();
+
   log ("Reading newsfile, credits, help-page, info and motd.");
   file_to_string (NEWS_FILE, news);
   file_to_string (CREDITS_FILE, credits);
@@ -127,10 +131,7 @@ void boot_db (void)
     WIN32CLEANUP
     exit (0);
   }
-  if (!(help_fl = fopen (HELP_KWRD_FILE, "rb")))
-    log ("   Could not open help file.");
-  else
-    help_index = build_help_index (help_fl, &top_of_helpt);
+  boot_help ();
 
 
   log ("Loading zone table.");
@@ -140,6 +141,8 @@ void boot_db (void)
   boot_world ();
   log ("Renumbering rooms.");
   renum_world ();
+  log ("Linking zones.");
+  link_zones ();
 
   log ("Generating index tables for mobile and object files.");
   mob_index = generate_indices (mob_f, &top_of_mobt);
@@ -175,15 +178,18 @@ void boot_db (void)
   log ("   Spells.");
   assign_spell_pointers ();
 
-  log ("Updating characters with saved items:");
+  log ("Indexing the rent file:");
   update_obj_file ();
 
-  for (i = 0; i <= top_of_zone_table; i++) {
-    fprintf (stderr, "Performing boot-time reset of %s (rooms %d-%d).\n",
-      zone_table[i].name,
-      (i ? (zone_table[i - 1].top + 1) : 0), zone_table[i].top);
-    reset_zone (i);
-  }
+  log ("Loading the world image:");
+  if (!world_load (IMAGE_FILE))
+    for (i = 0; i <= top_of_zone_table; i++) {
+      sprintf (buf, "Performing boot-time reset of %s (rooms %d-%d).",
+        zone_table[i].name,
+        (i ? (zone_table[i - 1].top + 1) : 0), zone_table[i].top);
+      log_at (LOG_BOOT, LOG_INFO, buf);
+      reset_zone (i);
+    }
 
   reset_q.head = reset_q.tail = 0;
 
@@ -436,6 +442,7 @@ struct index_data *generate_indices (FILE * fl, int *top)
         index[i].pos = ftell (fl);
         index[i].number = 0;
         index[i].func = 0;
+        index[i].cmds = 0;
         i++;
       } else if (*buf == '$')   /* EOF */
         break;
@@ -505,9 +512,11 @@ void boot_world (void)
       world[room_nr].sector_type = tmp;
 
       world[room_nr].funct = 0;
+      world[room_nr].spec_count = 0;
       world[room_nr].contents = 0;
       world[room_nr].people = 0;
       world[room_nr].light = 0; /* Zero light sources */
+      room_light (room_nr, 0);
 
       for (tmp = 0; tmp <= 5; tmp++)
         world[room_nr].dir_option[tmp] = 0;
@@ -607,6 +616,54 @@ void renum_world (void)
 }
 
 
+static void add_neighbour (int from, int to)
+{
+  struct zone_data *zone = &zone_table[from];
+  int i;
+
+  for (i = 0; i < zone->num_neighbours; i++)
+    if (zone->neighbour[i] == to)
+      return;
+
+  if (zone->neighbour)
+    RECREATE (zone->neighbour, int, zone->num_neighbours + 1);
+  else
+    CREATE (zone->neighbour, int, 1);
+  zone->neighbour[zone->num_neighbours++] = to;
+}
+
+/* record which zones border each other, for waking up mobile activity.
+   Exits may be one way, so the relation is made symmetric: a player can
+   walk in one direction and a mobile in the other. */
+void link_zones (void)
+{
+  register int room, door;
+  int i, from, to;
+
+  for (i = 0; i <= top_of_zone_table; i++) {
+    zone_table[i].neighbour = 0;
+    zone_table[i].num_neighbours = 0;
+    zone_table[i].awake = -1;
+    zone_table[i].mobs = 0;
+  }
+
+  if (top_of_zone_table < 0)
+    return;
+
+  for (room = 0; room <= top_of_world; room++)
+    for (door = 0; door <= 5; door++)
+      if (world[room].dir_option[door] &&
+        world[room].dir_option[door]->to_room != NOWHERE) {
+        from = world[room].zone;
+        to = world[world[room].dir_option[door]->to_room].zone;
+        if (from != to) {
+          add_neighbour (from, to);
+          add_neighbour (to, from);
+        }
+      }
+}
+
+
 #ifdef NEW_ZONE_SYSTEM
 
 void renum_zone_table (void)
@@ -935,6 +992,7 @@ struct char_data *read_mobile (int nr, int type)
 
   fscanf (mob_f, " %ld ", &tmp);
   mob->specials.affected_by = tmp;
+  update_sight (mob);
 
   fscanf (mob_f, " %ld ", &tmp);
   mob->specials.alignment = tmp;
@@ -959,7 +1017,7 @@ struct char_data *read_mobile (int nr, int type)
     mob->points.armor = 10 * tmp;
 
     fscanf (mob_f, " %ldd%ld+%ld ", &tmp, &tmp2, &tmp3);
-    mob->points.max_hit = dice (tmp, tmp2) + tmp3;
+    mob->points.max_hit = rng_dice (RNG_LOOT, tmp, tmp2) + tmp3;
     mob->points.hit = mob->points.max_hit;
 
     fscanf (mob_f, " %ldd%ld+%ld \n", &tmp, &tmp2, &tmp3);
@@ -1022,7 +1080,7 @@ struct char_data *read_mobile (int nr, int type)
     fscanf (mob_f, " %ld ", &tmp);
     fscanf (mob_f, " %ld ", &tmp2);
 
-    mob->points.max_hit = number (tmp, tmp2);
+    mob->points.max_hit = rng_number (RNG_LOOT, tmp, tmp2);
     mob->points.hit = mob->points.max_hit;
 
     fscanf (mob_f, " %ld ", &tmp);
@@ -1278,7 +1336,7 @@ void zone_update (void)
 /* execute the reset command table of a given zone */
 void reset_zone (int zone)
 {
-  int cmd_no, last_cmd = 1;
+  int cmd_no, last_cmd = 1, mobs = 0, objs = 0;
   char buf[256];
   struct obj_data *obj, *obj_to;
   struct char_data *mob = NULL;
@@ -1293,6 +1351,7 @@ void reset_zone (int zone)
         if (mob_index[ZCMD.arg1].number < ZCMD.arg2) {
           mob = read_mobile (ZCMD.arg1, REAL);
           char_to_room (mob, ZCMD.arg3);
+          mobs++;
           last_cmd = 1;
         } else
           last_cmd = 0;
@@ -1303,12 +1362,14 @@ void reset_zone (int zone)
           if (ZCMD.arg3 >= 0) {
             if (!get_obj_in_list_num (ZCMD.arg1, world[ZCMD.arg3].contents)) {
               obj = read_object (ZCMD.arg1, REAL);
+              objs++;
               obj_to_room (obj, ZCMD.arg3);
               last_cmd = 1;
             } else
               last_cmd = 0;
           } else {
             obj = read_object (ZCMD.arg1, REAL);
+            objs++;
             obj->in_room = NOWHERE;
             last_cmd = 1;
         } else
@@ -1318,6 +1379,7 @@ void reset_zone (int zone)
       case 'P':                /* object to object */
         if (obj_index[ZCMD.arg1].number < ZCMD.arg2) {
           obj = read_object (ZCMD.arg1, REAL);
+          objs++;
           obj_to = get_obj_num (ZCMD.arg3);
           obj_to_obj (obj, obj_to);
           last_cmd = 1;
@@ -1328,6 +1390,7 @@ void reset_zone (int zone)
       case 'G':                /* obj_to_char */
         if (obj_index[ZCMD.arg1].number < ZCMD.arg2) {
           obj = read_object (ZCMD.arg1, REAL);
+          objs++;
           obj_to_char (obj, mob);
           last_cmd = 1;
         } else
@@ -1337,6 +1400,7 @@ void reset_zone (int zone)
       case 'E':                /* object to equipment list */
         if (obj_index[ZCMD.arg1].number < ZCMD.arg2) {
           obj = read_object (ZCMD.arg1, REAL);
+          objs++;
           equip_char (mob, obj, ZCMD.arg3);
           last_cmd = 1;
         } else
@@ -1380,6 +1444,7 @@ void reset_zone (int zone)
   }
 
   zone_table[zone].age = 0;
+  EVENT (EVENT_RESET, 0, zone, mobs, objs);
 }
 
 #undef ZCMD
@@ -1392,7 +1457,7 @@ void reset_zone (int zone)
 /* execute the reset command table of a given zone */
 void reset_zone (int zone)
 {
-  int cmd_no, last_cmd = 1;
+  int cmd_no, last_cmd = 1, mobs = 0, objs = 0;
   char buf[256];
   struct obj_data *obj, *obj_to;
   struct char_data *mob = NULL;
@@ -1407,6 +1472,7 @@ void reset_zone (int zone)
         if (mob_index[ZCMD.arg1].number < ZCMD.arg2) {
           mob = read_mobile (ZCMD.arg1, REAL);
           char_to_room (mob, ZCMD.arg3);
+          mobs++;
           last_cmd = 1;
         } else
           last_cmd = 0;
@@ -1417,12 +1483,14 @@ void reset_zone (int zone)
           if (ZCMD.arg3 >= 0) {
             if (!get_obj_in_list_num (ZCMD.arg1, world[ZCMD.arg3].contents)) {
               obj = read_object (ZCMD.arg1, REAL);
+              objs++;
               obj_to_room (obj, ZCMD.arg3);
               last_cmd = 1;
             } else
               last_cmd = 0;
           } else {
             obj = read_object (ZCMD.arg1, REAL);
+            objs++;
             obj->in_room = NOWHERE;
             last_cmd = 1;
         } else
@@ -1486,6 +1554,7 @@ void reset_zone (int zone)
   }
 
   zone_table[zone].age = 0;
+  EVENT (EVENT_RESET, 0, zone, mobs, objs);
 }
 
 #undef ZCMD
@@ -1523,6 +1592,7 @@ int load_char (char *name, struct char_file_u *char_element)
 
   if ((player_i = find_name (name)) >= 0) {
 
+    journal_read (JOURNAL_PLAYERS);
     if (!(fl = fopen (PLAYER_FILE, "rb"))) {
       perror ("Opening player file for reading. (db.c, load_char)");
       WIN32CLEANUP
@@ -1611,6 +1681,7 @@ void store_to_char (struct char_file_u *st, struct char_data *ch)
     if (st->affected[i].type)
       affect_to_char (ch, &st->affected[i]);
   }
+  affect_timers_stop (ch);      /* until the player enters the game */
   ch->in_room = st->load_room;
   affect_total (ch);
 }                               /* store_to_char */
@@ -1637,6 +1708,7 @@ void char_to_store (struct char_data *ch, struct char_file_u *st)
   for (af = ch->affected, i = 0; i < MAX_AFFECT; i++) {
     if (af) {
       st->affected[i] = *af;
+      st->affected[i].duration = affect_duration (af);
       st->affected[i].next = 0;
       /* subtract effect of the spell or the effect will be doubled */
       affect_modify (ch, st->affected[i].location,
@@ -1765,40 +1837,712 @@ int create_entry (char *name)
 void save_char (struct char_data *ch, sh_int load_room)
 {
   struct char_file_u st;
-  FILE *fl;
-  char mode[4];
-  int expand;
 
   if (IS_NPC (ch) || !ch->desc)
     return;
 
-  if (expand = (ch->desc->pos > top_of_p_file)) {
-    strcpy (mode, "a+b");
+  if (ch->desc->pos > top_of_p_file)
     top_of_p_file++;
-  } else
-    strcpy (mode, "r+b");
 
   char_to_store (ch, &st);
   st.load_room = load_room;
 
   strcpy (st.pwd, ch->desc->pwd);
 
-  if (!(fl = fopen (PLAYER_FILE, mode))) {
-    perror ("save char");
+  /* written in place once the journal is synced, at the end of the pulse */
+  journal_write (JOURNAL_PLAYERS, ch->desc->pos * sizeof (struct char_file_u),
+    &st, sizeof (struct char_file_u));
+}
+
+
+
+/*************************************************************************
+*  the save journal                                                      *
+*********************************************************************** */
+
+/* Saves to the player and rent files are appended to the journal and
+   kept in memory until the end of the pulse, when the journal is synced
+   for all the saves of that pulse and only then are they written in
+   place.  If the game dies before the files themselves have been synced,
+   boot writes the journalled saves again.  Once in a while the files are
+   synced and the journal emptied.                                       */
+
+#define JOURNAL_MAGIC      0x4a524e4cUL
+#define JOURNAL_MAX_RECORD 65536        /* longer lengths mean a torn record */
+#define JOURNAL_MAX_SIZE   (1024L * 1024L)      /* checkpoint beyond this */
+
+struct journal_head {
+  unsigned long magic;
+  int file;                     /* JOURNAL_PLAYERS or JOURNAL_RENT */
+  int length;                   /* of the data after the head */
+  long pos;                     /* where the data goes in the file */
+  unsigned long sum;            /* of the above and the data */
+};
+
+static char *journal_files[JOURNAL_FILES] = { PLAYER_FILE, RENT_FILE };
+
+/* a save waiting for the journal to be synced */
+struct journal_pending {
+  int file;
+  int length;
+  long pos;
+  char *data;
+  struct journal_pending *next;
+};
+
+static FILE *journal_fl = 0;
+static long journal_size = 0;
+static int journal_dirty = FALSE;
+static struct journal_pending *pending_head = 0, *pending_tail = 0;
+static int pending_count[JOURNAL_FILES];
+
+
+static unsigned long journal_sum (struct journal_head *head, char *data)
+{
+  unsigned long sum = 2166136261UL;
+  int i;
+
+  sum = ((sum ^ (unsigned long) head->file) * 16777619UL) & 0xffffffffUL;
+  sum = ((sum ^ (unsigned long) head->length) * 16777619UL) & 0xffffffffUL;
+  sum = ((sum ^ (unsigned long) head->pos) * 16777619UL) & 0xffffffffUL;
+  for (i = 0; i < head->length; i++)
+    sum = ((sum ^ (unsigned char) data[i]) * 16777619UL) & 0xffffffffUL;
+
+  return (sum);
+}
+
+
+/* start an empty journal */
+static void journal_open (void)
+{
+  if (journal_fl)
+    fclose (journal_fl);
+
+  if (!(journal_fl = fopen (JOURNAL_FILE, "w+b"))) {
+    perror ("Opening journal");
+    WIN32CLEANUP
+    exit (1);
+  }
+
+  journal_size = 0;
+  journal_dirty = FALSE;
+}
+
+
+/* get the journalled files to the disk */
+static void journal_sync_files (void)
+{
+  FILE *fl;
+  int i;
+
+  for (i = 0; i < JOURNAL_FILES; i++)
+    if ((fl = fopen (journal_files[i], "r+b"))) {
+      fsync (fileno (fl));
+      fclose (fl);
+    }
+}
+
+
+/* write the pending saves in place, in the order they were made */
+static void journal_apply (void)
+{
+  struct journal_pending *jp;
+  FILE *files[JOURNAL_FILES];
+  int i;
+
+  for (i = 0; i < JOURNAL_FILES; i++)
+    files[i] = 0;
+
+  for (; (jp = pending_head); free (jp)) {
+    pending_head = jp->next;
+
+    if (!files[jp->file] &&
+      !(files[jp->file] = fopen (journal_files[jp->file], "r+b")) &&
+      !(files[jp->file] = fopen (journal_files[jp->file], "w+b"))) {
+      perror ("Applying journal");
+      WIN32CLEANUP
+      exit (1);
+    }
+
+    if (fseek (files[jp->file], jp->pos, 0) || (jp->length &&
+        fwrite (jp->data, jp->length, 1, files[jp->file]) < 1)) {
+      perror ("Applying journal");
+      WIN32CLEANUP
+      exit (1);
+    }
+    if (jp->data)
+      free (jp->data);
+  }
+
+  for (i = 0; i < JOURNAL_FILES; i++) {
+    if (files[i])
+      fclose (files[i]);
+    pending_count[i] = 0;
+  }
+  pending_tail = 0;
+}
+
+
+/* note a write of length bytes at pos in one of the journalled files */
+void journal_write (int file, long pos, void *data, int length)
+{
+  struct journal_head head;
+  struct journal_pending *jp;
+
+  head.magic = JOURNAL_MAGIC;
+  head.file = file;
+  head.length = length;
+  head.pos = pos;
+  head.sum = journal_sum (&head, (char *) data);
+
+  if (fwrite (&head, sizeof (head), 1, journal_fl) < 1 ||
+    (length && fwrite (data, length, 1, journal_fl) < 1)) {
+    perror ("Writing journal");
     WIN32CLEANUP
     exit (1);
   }
 
-  fflush (fl);
-  if (expand) {
-    fwrite (&st, sizeof (struct char_file_u), 1, fl);
+  journal_size += sizeof (head) + length;
+  journal_dirty = TRUE;
+
+  CREATE (jp, struct journal_pending, 1);
+  jp->file = file;
+  jp->pos = pos;
+  jp->length = length;
+  jp->data = 0;
+  jp->next = 0;
+  if (length) {
+    CREATE (jp->data, char, length);
+    memcpy (jp->data, data, length);
   }
+  if (pending_tail)
+    pending_tail->next = jp;
+  else
+    pending_head = jp;
+  pending_tail = jp;
+  pending_count[file]++;
+}
 
-  fseek (fl, ch->desc->pos * sizeof (struct char_file_u), 0);
 
-  fwrite (&st, sizeof (struct char_file_u), 1, fl);
+/* bring one of the files up to date before reading it */
+void journal_read (int file)
+{
+  if (pending_count[file])
+    journal_commit ();
+}
+
+
+/* make this pulse's saves durable, then write them in place; called
+   once a pulse */
+void journal_commit (void)
+{
+  if (journal_dirty) {
+    fflush (journal_fl);
+    fsync (fileno (journal_fl));
+    journal_dirty = FALSE;
+  }
+
+  if (pending_head)
+    journal_apply ();
+
+  if (journal_size > JOURNAL_MAX_SIZE) {
+    journal_sync_files ();
+    journal_open ();
+  }
+}
+
+
+/* sync the files and empty the journal */
+void journal_checkpoint (void)
+{
+  journal_commit ();
+
+  if (journal_size) {
+    journal_sync_files ();
+    journal_open ();
+  }
+}
+
+
+/* write the saves in the journal, up to the first torn record, into the
+   files, and start a new journal */
+void journal_replay (void)
+{
+  struct journal_head head;
+  FILE *fl, *files[JOURNAL_FILES];
+  char *data, buf[MAX_STRING_LENGTH];
+  int i, count = 0;
+
+  if ((fl = fopen (JOURNAL_FILE, "rb"))) {
+    CREATE (data, char, JOURNAL_MAX_RECORD);
+    for (i = 0; i < JOURNAL_FILES; i++)
+      files[i] = 0;
+
+    while (fread (&head, sizeof (head), 1, fl) == 1) {
+      if (head.magic != JOURNAL_MAGIC || head.file < 0 ||
+        head.file >= JOURNAL_FILES || head.length < 0 ||
+        head.length > JOURNAL_MAX_RECORD || head.pos < 0)
+        break;
+      if (head.length && fread (data, head.length, 1, fl) < 1)
+        break;
+      if (journal_sum (&head, data) != head.sum)
+        break;
+
+      if (!files[head.file] &&
+        !(files[head.file] = fopen (journal_files[head.file], "r+b")) &&
+        !(files[head.file] = fopen (journal_files[head.file], "w+b"))) {
+        perror ("Replaying journal");
+        WIN32CLEANUP
+        exit (1);
+      }
+
+      fseek (files[head.file], head.pos, 0);
+      fwrite (data, head.length, 1, files[head.file]);
+      count++;
+    }
+
+    for (i = 0; i < JOURNAL_FILES; i++)
+      if (files[i])
+        fclose (files[i]);
+
+    free (data);
+    fclose (fl);
 
+    if (count) {
+      sprintf (buf, "   Replayed %d saves.", count);
+      log_at (LOG_SAVE, LOG_INFO, buf);
+      journal_sync_files ();
+    }
+  }
+
+  journal_open ();
+}
+
+
+
+
+/*************************************************************************
+*  the world image                                                       *
+*********************************************************************** */
+
+/* The image is written by a forked child from its copy of the world, so
+   nothing here may change what the game itself would see afterwards.  */
+
+static int image_objs;
+
+
+/* write obj and its contents, returning FALSE on a write error.  Of
+   the objects not from the object file, corpses and coins are kept.  */
+static int world_save_obj (FILE * fl, struct obj_data *obj, int where,
+  int wear_pos, int in)
+{
+  struct world_obj_u rec;
+  struct obj_data *tmp;
+  int j, index;
+
+  memset (&rec, 0, sizeof (rec));
+  if (obj->item_number >= 0)
+    rec.obj.item_number = obj_index[obj->item_number].virtual;
+  else if (GET_ITEM_TYPE (obj) == ITEM_CONTAINER && obj->obj_flags.value[3]) {
+    rec.obj.item_number = IMAGE_CORPSE;
+    strncpy (rec.short_descr, obj->short_description,
+      sizeof (rec.short_descr) - 1);
+  } else if (GET_ITEM_TYPE (obj) == ITEM_MONEY && obj->obj_flags.value[0] > 0)
+    rec.obj.item_number = IMAGE_MONEY;
+  else
+    return (TRUE);
+
+  obj_timer_sync (obj);
+
+  for (j = 0; j < 4; j++)
+    rec.obj.value[j] = obj->obj_flags.value[j];
+  rec.obj.extra_flags = obj->obj_flags.extra_flags;
+  rec.obj.weight = obj->obj_flags.weight;
+  for (tmp = obj->contains; tmp; tmp = tmp->next_content)
+    rec.obj.weight -= GET_OBJ_WEIGHT (tmp);     /* added back on loading */
+  rec.obj.timer = obj->obj_flags.timer;
+  rec.obj.bitvector = obj->obj_flags.bitvector;
+  for (j = 0; j < MAX_OBJ_AFFECT; j++)
+    rec.obj.affected[j] = obj->affected[j];
+  rec.where = where;
+  rec.wear_pos = wear_pos;
+  rec.in = in;
+
+  if (fwrite (&rec, sizeof (rec), 1, fl) < 1)
+    return (FALSE);
+  index = image_objs++;
+
+  for (tmp = obj->contains; tmp; tmp = tmp->next_content)
+    if (!world_save_obj (fl, tmp, IMAGE_IN_OBJ, 0, index))
+      return (FALSE);
+
+  return (TRUE);
+}
+
+
+/* write what ch carries and wears, as the index'th character */
+static int world_save_char_objs (FILE * fl, struct char_data *ch, int index)
+{
+  struct obj_data *obj;
+  int pos, ok = TRUE;
+
+  for (obj = ch->carrying; ok && obj; obj = obj->next_content)
+    ok = world_save_obj (fl, obj, IMAGE_CARRIED, 0, index);
+  for (pos = 0; ok && pos < MAX_WEAR; pos++)
+    if (ch->equipment[pos])
+      ok = world_save_obj (fl, ch->equipment[pos], IMAGE_WORN, pos, index);
+
+  return (ok);
+}
+
+
+/* write what ch carries and wears to fl, for world_load_objs().  Returns
+   the number of objects written, or -1.                                */
+int world_save_objs (FILE * fl, struct char_data *ch)
+{
+  image_objs = 0;
+  return (world_save_char_objs (fl, ch, 0) ? image_objs : -1);
+}
+
+
+/* write the state of the world to name, by way of a temporary file so
+   that a half written image never replaces a whole one.  Returns the
+   number of objects written, or -1.                                     */
+int world_save (char *name)
+{
+  struct world_image_head head;
+  struct world_door_u door;
+  struct world_mob_u mob;
+  struct char_data *ch;
+  struct obj_data *obj;
+  char tmp_name[256];
+  FILE *fl;
+  int room, dir, zone, ok = TRUE;
+
+  sprintf (tmp_name, "%s.new", name);
+  if (!(fl = fopen (tmp_name, "wb"))) {
+    perror ("world_save");
+    return (-1);
+  }
+
+  memset (&head, 0, sizeof (head));
+  head.magic = WORLD_IMAGE_MAGIC;
+  head.version = WORLD_IMAGE_VERSION;
+  head.record_size = sizeof (struct world_door_u) +
+    sizeof (struct world_mob_u) + sizeof (struct world_obj_u);
+  head.saved = time (0);
+  head.num_rooms = top_of_world + 1;
+  head.num_zones = top_of_zone_table + 1;
+  ok = fwrite (&head, sizeof (head), 1, fl) == 1;
+
+  for (zone = 0; ok && zone <= top_of_zone_table; zone++)
+    ok = fwrite (&zone_table[zone].age, sizeof (int), 1, fl) == 1;
+
+  for (room = 0; ok && room <= top_of_world; room++)
+    for (dir = 0; ok && dir <= 5; dir++)
+      if (world[room].dir_option[dir] &&
+        IS_SET (world[room].dir_option[dir]->exit_info, EX_ISDOOR)) {
+        door.room = world[room].number;
+        door.dir = dir;
+        door.exit_info = world[room].dir_option[dir]->exit_info;
+        ok = fwrite (&door, sizeof (door), 1, fl) == 1;
+        head.num_doors++;
+      }
+
+  for (ch = character_list; ok && ch; ch = ch->next)
+    if (IS_MOB (ch) && ch->in_room != NOWHERE) {
+      memset (&mob, 0, sizeof (mob));
+      mob.item_number = mob_index[ch->nr].virtual;
+      mob.room = world[ch->in_room].number;
+      mob.points = ch->points;
+      mob.alignment = ch->specials.alignment;
+      mob.position = ch->specials.position;
+      mob.act = ch->specials.act;
+      ok = fwrite (&mob, sizeof (mob), 1, fl) == 1;
+      head.num_mobs++;
+    }
+
+  image_objs = 0;
+
+  for (room = 0; ok && room <= top_of_world; room++)
+    for (obj = world[room].contents; ok && obj; obj = obj->next_content)
+      ok = world_save_obj (fl, obj, IMAGE_IN_ROOM, 0, world[room].number);
+
+  head.num_mobs = 0;
+  for (ch = character_list; ok && ch; ch = ch->next)
+    if (IS_MOB (ch) && ch->in_room != NOWHERE)
+      ok = world_save_char_objs (fl, ch, head.num_mobs++);
+
+  head.num_objs = image_objs;
+  if (ok) {
+    fseek (fl, 0L, 0);
+    ok = fwrite (&head, sizeof (head), 1, fl) == 1;
+  }
+  if (fclose (fl) || !ok || rename (tmp_name, name)) {
+    perror ("world_save");
+    unlink (tmp_name);
+    return (-1);
+  }
+
+  return (image_objs);
+}
+
+
+static char *world_str_dup (char *str)
+{
+  return (str ? str_dup (str) : 0);
+}
+
+
+/* a corpse as make_corpse() leaves it, but for what is in it */
+static struct obj_data *world_load_corpse (struct world_obj_u *rec)
+{
+  struct obj_data *corpse;
+  char buf[MAX_STRING_LENGTH];
+
+  CREATE (corpse, struct obj_data, 1);
+  clear_object (corpse);
+
+  corpse->name = str_dup ("corpse");
+  sprintf (buf, "%s is lying here.", rec->short_descr);
+  corpse->description = str_dup (buf);
+  corpse->short_description = str_dup (rec->short_descr);
+
+  corpse->obj_flags.type_flag = ITEM_CONTAINER;
+  corpse->obj_flags.wear_flags = ITEM_TAKE;
+  corpse->obj_flags.cost_per_day = 100000;
+
+  corpse->next = object_list;
+  object_list = corpse;
+
+  return (corpse);
+}
+
+
+/* make the object stored in rec, or return 0 if it is no more.  Only
+   the first object of each kind is read from the object file; the rest
+   are copied from it, which saves parsing the file again and again.   */
+static struct obj_data *world_load_obj (struct world_obj_u *rec,
+  struct obj_data **first)
+{
+  struct obj_data *obj;
+  struct extra_descr_data *descr, **tail;
+  int nr, j;
+
+  if (rec->obj.item_number == IMAGE_CORPSE) {
+    rec->short_descr[sizeof (rec->short_descr) - 1] = '\0';
+    obj = world_load_corpse (rec);
+  } else if (rec->obj.item_number == IMAGE_MONEY) {
+    if (rec->obj.value[0] <= 0)
+      return (0);
+    obj = create_money (rec->obj.value[0]);
+  } else if ((nr = real_object (rec->obj.item_number)) < 0)
+    return (0);
+  else if (!first[nr])
+    obj = first[nr] = read_object (nr, REAL);
+  else {
+    CREATE (obj, struct obj_data, 1);
+    clear_object (obj);
+    obj->obj_flags = first[nr]->obj_flags;
+    obj->name = world_str_dup (first[nr]->name);
+    obj->short_description = world_str_dup (first[nr]->short_description);
+    obj->description = world_str_dup (first[nr]->description);
+    obj->action_description = world_str_dup (first[nr]->action_description);
+
+    tail = &obj->ex_description;
+    for (descr = first[nr]->ex_description; descr; descr = descr->next) {
+      CREATE (*tail, struct extra_descr_data, 1);
+      (*tail)->keyword = world_str_dup (descr->keyword);
+      (*tail)->description = world_str_dup (descr->description);
+      tail = &(*tail)->next;
+    }
+    *tail = 0;
+
+    obj->item_number = nr;
+    obj->next = object_list;
+    object_list = obj;
+    obj_index[nr].number++;
+  }
+
+  for (j = 0; j < 4; j++)
+    obj->obj_flags.value[j] = rec->obj.value[j];
+  obj->obj_flags.extra_flags = rec->obj.extra_flags;
+  obj->obj_flags.weight = rec->obj.weight;
+  obj->obj_flags.timer = rec->obj.timer;
+  obj->obj_flags.bitvector = rec->obj.bitvector;
+  for (j = 0; j < MAX_OBJ_AFFECT; j++)
+    obj->affected[j] = rec->obj.affected[j];
+
+  if (rec->obj.item_number == IMAGE_CORPSE)
+    obj_timer_start (obj);      /* decays as it would have */
+
+  return (obj);
+}
+
+
+/* make the num objects in objs and put them where they were, on the
+   characters in mob if not in a room.  Returns how many are lost.
+
+   Containers come before what is in them; make them all, then place
+   them last to first, so every list keeps its order and contents are
+   in place before their container is weighed in.                       */
+static int world_make_objs (struct world_obj_u *objs, int num,
+  struct char_data **mob, int num_mobs)
+{
+  struct obj_data **obj, **first;
+  int i, room, lost = 0;
+
+  CREATE (obj, struct obj_data *, num + 1);
+  CREATE (first, struct obj_data *, top_of_objt + 1);
+  for (i = 0; i < num; i++)
+    if (!(obj[i] = world_load_obj (&objs[i], first)))
+      lost++;
+  free (first);
+
+  for (i = num - 1; i >= 0; i--) {
+    if (!obj[i])
+      continue;
+    switch (objs[i].where) {
+    case IMAGE_IN_ROOM:
+      if ((room = real_room (objs[i].in)) >= 0) {
+        obj_to_room (obj[i], room);
+        obj[i] = 0;
+      }
+      break;
+    case IMAGE_CARRIED:
+    case IMAGE_WORN:
+      if (objs[i].in < 0 || objs[i].in >= num_mobs || !mob[objs[i].in])
+        break;
+      if (objs[i].where == IMAGE_WORN && objs[i].wear_pos >= 0 &&
+        objs[i].wear_pos < MAX_WEAR &&
+        !mob[objs[i].in]->equipment[objs[i].wear_pos])
+        equip_char (mob[objs[i].in], obj[i], objs[i].wear_pos);
+      else
+        obj_to_char (obj[i], mob[objs[i].in]);
+      obj[i] = 0;
+      break;
+    case IMAGE_IN_OBJ:
+      if (objs[i].in >= 0 && objs[i].in < i && obj[objs[i].in]) {
+        obj_to_obj (obj[i], obj[objs[i].in]);
+        obj[i] = 0;
+      }
+      break;
+    }
+    if (obj[i]) {
+      extract_obj (obj[i]);
+      lost++;
+    }
+  }
+
+  free (obj);
+  return (lost);
+}
+
+
+/* rebuild the world from the image in name instead of resetting every
+   zone.  Returns FALSE, having changed nothing, if there is no image or
+   it was not taken of this world by this version of the game.          */
+int world_load (char *name)
+{
+  struct world_image_head head;
+  struct world_door_u *doors;
+  struct world_mob_u *mobs;
+  struct world_obj_u *objs;
+  struct char_data **mob;
+  char buf[MAX_STRING_LENGTH], *data;
+  FILE *fl;
+  long size;
+  int i, room, lost = 0;
+
+  if (!(fl = fopen (name, "rb")))
+    return (FALSE);
+
+  if (fread (&head, sizeof (head), 1, fl) < 1 ||
+    head.magic != WORLD_IMAGE_MAGIC ||
+    head.version != WORLD_IMAGE_VERSION ||
+    head.record_size != sizeof (struct world_door_u) +
+    sizeof (struct world_mob_u) + sizeof (struct world_obj_u) ||
+    head.num_rooms != top_of_world + 1 ||
+    head.num_zones != top_of_zone_table + 1 ||
+    head.num_doors < 0 || head.num_mobs < 0 || head.num_objs < 0) {
+    log_at (LOG_SAVE, LOG_WARN, "   The world image does not fit this world.");
+    fclose (fl);
+    return (FALSE);
+  }
+
+  size = head.num_zones * (long) sizeof (int) +
+    head.num_doors * (long) sizeof (struct world_door_u) +
+    head.num_mobs * (long) sizeof (struct world_mob_u) +
+    head.num_objs * (long) sizeof (struct world_obj_u);
+  CREATE (data, char, size + 1);
+  if (fread (data, 1, size, fl) != (size_t) size) {
+    log_at (LOG_SAVE, LOG_WARN, "   The world image is cut short.");
+    free (data);
+    fclose (fl);
+    return (FALSE);
+  }
   fclose (fl);
+
+  for (i = 0; i < head.num_zones; i++)
+    zone_table[i].age = ((int *) data)[i];
+
+  doors = (struct world_door_u *) (data + head.num_zones * sizeof (int));
+  for (i = 0; i < head.num_doors; i++)
+    if ((room = real_room (doors[i].room)) >= 0 &&
+      doors[i].dir >= 0 && doors[i].dir <= 5 &&
+      world[room].dir_option[doors[i].dir])
+      world[room].dir_option[doors[i].dir]->exit_info = doors[i].exit_info;
+
+  /* made last to first, so that character_list keeps its order */
+  mobs = (struct world_mob_u *) (doors + head.num_doors);
+  CREATE (mob, struct char_data *, head.num_mobs + 1);
+  for (i = head.num_mobs - 1; i >= 0; i--)
+    if ((room = real_room (mobs[i].room)) >= 0 &&
+      real_mobile (mobs[i].item_number) >= 0) {
+      mob[i] = read_mobile (mobs[i].item_number, VIRTUAL);
+      char_to_room (mob[i], room);
+    } else
+      lost++;
+
+  objs = (struct world_obj_u *) (mobs + head.num_mobs);
+  lost += world_make_objs (objs, head.num_objs, mob, head.num_mobs);
+
+  /* the stored points already count the equipment in */
+  for (i = 0; i < head.num_mobs; i++)
+    if (mob[i]) {
+      mob[i]->points = mobs[i].points;
+      mob[i]->specials.alignment = mobs[i].alignment;
+      mob[i]->specials.act = mobs[i].act;
+      if (mobs[i].position == POSITION_FIGHTING)
+        mob[i]->specials.position = mob[i]->specials.default_pos;
+      else
+        mob[i]->specials.position = mobs[i].position;
+    }
+
+  sprintf (buf, "   %d mobiles and %d objects, %d no longer in the world.",
+    head.num_mobs, head.num_objs, lost);
+  log (buf);
+
+  free (mob);
+  free (data);
+  return (TRUE);
+}
+
+
+/* give ch the num objects written to fl by world_save_objs().  Returns
+   FALSE if the file is cut short.                                      */
+int world_load_objs (FILE * fl, struct char_data *ch, int num)
+{
+  struct world_obj_u *objs;
+  int ok;
+
+  CREATE (objs, struct world_obj_u, num + 1);
+  ok = fread (objs, sizeof (struct world_obj_u), num, fl) == (size_t) num;
+  if (ok)
+    world_make_objs (objs, num, &ch, 1);
+  free (objs);
+
+  return (ok);
 }
 
 
@@ -1878,6 +2622,7 @@ void free_char (struct char_data *ch)
   struct affected_type *af;
 
   free (GET_NAME (ch));
+  keywords_free (&ch->keywords);
 
   if (ch->player.title)
     free (ch->player.title);
@@ -1888,8 +2633,8 @@ void free_char (struct char_data *ch)
   if (ch->player.description)
     free (ch->player.description);
 
-  for (af = ch->affected; af; af = af->next)
-    affect_remove (ch, af);
+  while (ch->affected)
+    affect_remove (ch, ch->affected);
 
   free (ch);
 }
@@ -1906,6 +2651,7 @@ void free_obj (struct obj_data *obj)
   struct extra_descr_data *this, *next_one;
 
   free (obj->name);
+  keywords_free (&obj->keywords);
   if (obj->description)
     free (obj->description);
   if (obj->short_description)
@@ -2010,6 +2756,7 @@ void clear_char (struct char_data *ch)
   ch->specials.position = POSITION_STANDING;
   ch->specials.default_pos = POSITION_STANDING;
   GET_AC (ch) = 100;            /* Basic Armor */
+  update_sight (ch);
 }
 
 
@@ -2082,6 +2829,7 @@ void init_char (struct char_data *ch)
   }
 
   ch->specials.affected_by = 0;
+  update_sight (ch);
   ch->specials.spells_to_learn = 0;
 
   for (i = 0; i < 5; i++)
@@ -27,6 +27,15 @@
 #define INFO_FILE         "info"        /* for INFO                   */
 #define WIZLIST_FILE      "wizlist"     /* for WIZLIST                */
 #define POSEMESS_FILE     "poses"       /* for 'pose'-command         */
+#define RENT_FILE         "pcobjs.rent" /* rented objects             */
+#define JOURNAL_FILE      "journal"     /* saves not yet synced       */
+#define IMAGE_FILE        "world.image" /* snapshot of the world      */
+#define COPYOVER_FILE     "copyover"    /* players kept by a copyover */
+
+/* files written through the journal */
+#define JOURNAL_PLAYERS   0
+#define JOURNAL_RENT      1
+#define JOURNAL_FILES     2
 
 /* public procedures in db.c */
 
@@ -45,6 +54,15 @@ extern int real_object (int virtual);
 extern int real_mobile (int virtual);
 extern void update_time (void);
 extern void free_obj (struct obj_data *obj);
+extern void journal_write (int file, long pos, void *data, int length);
+extern void journal_read (int file);
+extern void journal_commit (void);
+extern void journal_checkpoint (void);
+extern void journal_replay (void);
+extern int world_save (char *name);
+extern int world_load (char *name);
+extern int world_save_objs (FILE * fl, struct char_data *ch);
+extern int world_load_objs (FILE * fl, struct char_data *ch, int num);
 
 #define REAL 0
 #define VIRTUAL 1
@@ -110,6 +128,11 @@ struct zone_data {
   int reset_mode;               /* conditions for reset (see below)   */
   struct reset_com *cmd;        /* command table for reset             */
 
+  int *neighbour;               /* zones reachable by a single exit   */
+  int num_neighbours;
+  int awake;                    /* mobile pulse this zone was last in use */
+  struct char_data *mobs;       /* the mobiles in this zone's rooms   */
+
   /*
    *  Reset mode:                              *
    *  0: Don't reset, and don't update age.    *
@@ -127,8 +150,12 @@ struct index_data {
   long pos;                     /* file position of this field              */
   int number;                   /* number of existing units of this mob/obj */
   int (*func) (struct char_data *ch, int cmd, char *arg);   /* special procedure for this mob/obj       */
+  int *cmds;                    /* commands func answers, 0 ends; NULL = all */
 };
 
+/* can the special procedure of index entry i answer any player command? */
+#define SPEC_LISTENS(i)  ((i).func && (!(i).cmds || *(i).cmds))
+
 
 /* for queueing zones for update   */
 struct reset_q_element {
@@ -153,7 +180,8 @@ struct player_index_element {
 
 struct help_index_element {
   char *keyword;
-  long pos;
+  char *text;                   /* the entry, in the help file image */
+  int length;
 };
 
 
@@ -0,0 +1,218 @@
+/* events: print an event stream written by the game (dmserver -e file).
+   Players are shown by their number in the player file, or by name if
+   the player file is given with -p.  With -s only the totals by type
+   and the busiest pulses are printed.                                 */
+
+#include "os.h"
+
+#include "structs.h"
+
+#define BUSIEST 5
+
+char *event_names[MAX_EVENT] = {
+  "file", "damage", "kill", "death", "exp", "loot", "reset", "login",
+  "buy", "sell"
+};
+
+char **names = 0;
+int num_names = 0;
+
+long count[MAX_EVENT];
+double total[MAX_EVENT];
+int busy_pulse[BUSIEST], busy_count[BUSIEST];
+
+void read_names (char *filename);
+void events (char *filename, int summary);
+char *who (int id, char *buf);
+void print_event (struct event_u *rec);
+void busy (int pulse, int num);
+
+int main (int argc, char **argv)
+{
+  int pos = 1, summary = 0, i;
+
+  for (; pos < argc && *argv[pos] == '-'; pos++)
+    if (argv[pos][1] == 's')
+      summary = 1;
+    else if (argv[pos][1] == 'p' && pos + 1 < argc)
+      read_names (argv[++pos]);
+    else
+      break;
+
+  if (pos >= argc) {
+    fprintf (stderr, "Usage: %s [-s] [-p playerfile] eventfile ...\n",
+      argv[0]);
+    return 1;
+  }
+
+  for (; pos < argc; pos++)
+    events (argv[pos], summary);
+
+  if (summary) {
+    printf ("%-8s %10s %14s\n", "event", "count", "total value");
+    for (i = 1; i < MAX_EVENT; i++)
+      printf ("%-8s %10ld %14.0f\n", event_names[i], count[i], total[i]);
+    printf ("\nBusiest pulses:\n");
+    for (i = 0; i < BUSIEST && busy_count[i]; i++)
+      printf ("  pulse %8d  %6d events\n", busy_pulse[i], busy_count[i]);
+  }
+  return 0;
+}
+
+
+void read_names (char *filename)
+{
+  FILE *fl;
+  struct char_file_u player;
+
+  if (!(fl = fopen (filename, "rb"))) {
+    perror (filename);
+    exit (1);
+  }
+
+  while (fread (&player, sizeof (player), 1, fl) == 1) {
+    if (!(names = (char **) realloc (names,
+          (num_names + 1) * sizeof (char *)))) {
+      perror ("realloc failure");
+      exit (1);
+    }
+    names[num_names] = (char *) malloc (strlen (player.name) + 1);
+    strcpy (names[num_names++], player.name);
+  }
+
+  fclose (fl);
+}
+
+
+void events (char *filename, int summary)
+{
+  FILE *fl;
+  struct event_u rec;
+  int pulse = -1, num = 0;
+
+  if (!(fl = fopen (filename, "rb"))) {
+    perror (filename);
+    exit (1);
+  }
+
+  if (fread (&rec, sizeof (rec), 1, fl) != 1 || rec.type != EVENT_FILE ||
+    rec.actor != EVENT_MAGIC) {
+    fprintf (stderr, "%s: not an event file.\n", filename);
+    exit (1);
+  }
+
+  do {
+    if (rec.type == EVENT_FILE) {
+      if (rec.target != sizeof (struct event_u) ||
+        rec.value != EVENT_VERSION) {
+        fprintf (stderr, "%s: events of version %d, %d bytes each; "
+          "this reads version %d, %d bytes.\n", filename, rec.value,
+          rec.target, EVENT_VERSION, (int) sizeof (struct event_u));
+        exit (1);
+      }
+      busy (pulse, num);        /* the game was restarted */
+      pulse = -1;
+      num = 0;
+    } else if (rec.type < 0 || rec.type >= MAX_EVENT) {
+      fprintf (stderr, "%s: bad event type %d.\n", filename, rec.type);
+      exit (1);
+    } else {
+      count[rec.type]++;
+      total[rec.type] += rec.value;
+      if (rec.pulse != pulse) {
+        busy (pulse, num);
+        pulse = rec.pulse;
+        num = 0;
+      }
+      num++;
+    }
+
+    if (!summary)
+      print_event (&rec);
+  } while (fread (&rec, sizeof (rec), 1, fl) == 1);
+
+  busy (pulse, num);
+  fclose (fl);
+}
+
+
+/* keep the BUSIEST pulses with the most events */
+void busy (int pulse, int num)
+{
+  int i, j;
+
+  for (i = 0; i < BUSIEST && busy_count[i] >= num; i++);
+  if (i >= BUSIEST || !num)
+    return;
+  for (j = BUSIEST - 1; j > i; j--) {
+    busy_pulse[j] = busy_pulse[j - 1];
+    busy_count[j] = busy_count[j - 1];
+  }
+  busy_pulse[i] = pulse;
+  busy_count[i] = num;
+}
+
+
+char *who (int id, char *buf)
+{
+  if (!id)
+    strcpy (buf, "-");
+  else if (id > 0)
+    sprintf (buf, "mob#%d", id);
+  else if (-1 - id < num_names)
+    strcpy (buf, names[-1 - id]);
+  else
+    sprintf (buf, "player#%d", -1 - id);
+  return (buf);
+}
+
+
+void print_event (struct event_u *rec)
+{
+  char stamp[30], actor[40], target[40];
+  time_t when = rec->time;
+
+  strcpy (stamp, ctime (&when));
+  stamp[strlen (stamp) - 1] = '\0';
+  printf ("%s %8d %5d %-6s %-12s ", stamp, rec->pulse, rec->room,
+    event_names[rec->type],
+    rec->type == EVENT_FILE ? "-" : who (rec->actor, actor));
+
+  switch (rec->type) {
+  case EVENT_FILE:
+    printf ("version %d, %d byte records\n", rec->value, rec->target);
+    break;
+  case EVENT_DAMAGE:
+    printf ("%s for %d (attack %d)\n", who (rec->target, target),
+      rec->value, rec->extra);
+    break;
+  case EVENT_KILL:
+    printf ("%s, level %d\n", who (rec->target, target), rec->value);
+    break;
+  case EVENT_DEATH:
+    printf ("level %d\n", rec->value);
+    break;
+  case EVENT_EXP:
+    printf ("%+d, now %d\n", rec->value, rec->extra);
+    break;
+  case EVENT_LOOT:
+    printf ("obj#%d worth %d", rec->target, rec->value);
+    if (rec->extra)
+      printf (", %d coins", rec->extra);
+    printf ("\n");
+    break;
+  case EVENT_RESET:
+    printf ("zone %d, %d mobiles, %d objects\n", rec->target, rec->value,
+      rec->extra);
+    break;
+  case EVENT_LOGIN:
+    printf ("level %d%s\n", rec->value, rec->extra == EV_LOGIN_NEW ?
+      ", new" : (rec->extra == EV_LOGIN_BACK ? ", reconnected" : ""));
+    break;
+  case EVENT_BUY:
+  case EVENT_SELL:
+    printf ("obj#%d for %d %s %s\n", rec->target, rec->value,
+      rec->type == EVENT_BUY ? "from" : "to", who (rec->extra, target));
+    break;
+  }
+}
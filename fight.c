@@ -28,6 +28,10 @@ extern struct room_data *world;
 extern struct message_list fight_messages[MAX_MESSAGES];
 extern struct obj_data *object_list;
 
+/* fight_messages entries by attack type */
+static struct message_list **fight_index = 0;
+static int fight_max_type = 0;
+
 /* External procedures */
 
 char *fread_string (FILE * f1);
@@ -63,14 +67,26 @@ void appear (struct char_data *ch)
     affect_from_char (ch, SPELL_INVISIBLE);
 
   REMOVE_BIT (ch->specials.affected_by, AFF_INVISIBLE);
+  update_sight (ch);
 }
 
 
 
+static void fread_msg (FILE * f1, struct msg_type *msg)
+{
+  msg->attacker_msg = fread_string (f1);
+  msg->victim_msg = fread_string (f1);
+  msg->room_msg = fread_string (f1);
+  msg->attacker_act = act_prepare (msg->attacker_msg);
+  msg->victim_act = act_prepare (msg->victim_msg);
+  msg->room_act = act_prepare (msg->room_msg);
+}
+
+
 void load_messages (void)
 {
   FILE *f1;
-  int i, type;
+  int i, type, size[MAX_MESSAGES];
   struct message_type *messages;
   char chk[100];
 
@@ -84,6 +100,7 @@ void load_messages (void)
     fight_messages[i].a_type = 0;
     fight_messages[i].number_of_attacks = 0;
     fight_messages[i].msg = 0;
+    size[i] = 0;
   }
 
   fscanf (f1, " %s \n", chk);
@@ -92,34 +109,40 @@ void load_messages (void)
     fscanf (f1, " %d\n", &type);
     for (i = 0; (i < MAX_MESSAGES) && (fight_messages[i].a_type != type) &&
       (fight_messages[i].a_type); i++);
-    if (i >= MAX_MESSAGES) {
+    if (i >= MAX_MESSAGES || type < 0) {
       log ("Too many combat messages.");
       WIN32CLEANUP
       exit (0);
     }
 
-    CREATE (messages, struct message_type, 1);
-    fight_messages[i].number_of_attacks++;
+    if (fight_messages[i].number_of_attacks >= size[i]) {
+      size[i] = size[i] ? size[i] * 2 : 4;
+      if (!(fight_messages[i].msg = (struct message_type *)
+          realloc (fight_messages[i].msg,
+            sizeof (struct message_type) * size[i]))) {
+        perror ("load_messages. realloc");
+        WIN32CLEANUP
+        exit (1);
+      }
+    }
+    messages = &fight_messages[i].msg[fight_messages[i].number_of_attacks++];
+    memset (messages, 0, sizeof (struct message_type));
     fight_messages[i].a_type = type;
-    messages->next = fight_messages[i].msg;
-    fight_messages[i].msg = messages;
-
-    messages->die_msg.attacker_msg = fread_string (f1);
-    messages->die_msg.victim_msg = fread_string (f1);
-    messages->die_msg.room_msg = fread_string (f1);
-    messages->miss_msg.attacker_msg = fread_string (f1);
-    messages->miss_msg.victim_msg = fread_string (f1);
-    messages->miss_msg.room_msg = fread_string (f1);
-    messages->hit_msg.attacker_msg = fread_string (f1);
-    messages->hit_msg.victim_msg = fread_string (f1);
-    messages->hit_msg.room_msg = fread_string (f1);
-    messages->god_msg.attacker_msg = fread_string (f1);
-    messages->god_msg.victim_msg = fread_string (f1);
-    messages->god_msg.room_msg = fread_string (f1);
+    fight_max_type = MAX (fight_max_type, type);
+
+    fread_msg (f1, &messages->die_msg);
+    fread_msg (f1, &messages->miss_msg);
+    fread_msg (f1, &messages->hit_msg);
+    fread_msg (f1, &messages->god_msg);
     fscanf (f1, " %s \n", chk);
   }
 
   fclose (f1);
+
+  /* index the message sets by attack type */
+  CREATE (fight_index, struct message_list *, fight_max_type + 1);
+  for (i = 0; i < MAX_MESSAGES && fight_messages[i].a_type; i++)
+    fight_index[fight_messages[i].a_type] = &fight_messages[i];
 }
 
 
@@ -235,11 +258,13 @@ void make_corpse (struct char_data *ch)
     corpse->obj_flags.timer = MAX_NPC_CORPSE_TIME;
   else
     corpse->obj_flags.timer = MAX_PC_CORPSE_TIME;
+  obj_timer_start (corpse);
 
   for (i = 0; i < MAX_WEAR; i++)
     if (ch->equipment[i])
       obj_to_obj (unequip_char (ch, i), corpse);
 
+  ch->spec_count -= obj_specials (ch->carrying);
   ch->carrying = 0;
   IS_CARRYING_N (ch) = 0;
   IS_CARRYING_W (ch) = 0;
@@ -299,6 +324,8 @@ void death_cry (struct char_data *ch)
 
 void raw_kill (struct char_data *ch)
 {
+  EVENT (EVENT_DEATH, ch, 0, GET_LEVEL (ch), 0);
+
   if (ch->specials.fighting)
     stop_fighting (ch);
 
@@ -391,144 +418,71 @@ char *replace_string (char *str, char *weapon)
 
 
 
+#define DAM_WEAPONS   (TYPE_SLASH - TYPE_HIT + 1)
+#define DAM_DEGREES   8
+
 void dam_message (int dam, struct char_data *ch, struct char_data *victim,
   int w_type)
 {
   struct obj_data *wield;
-  char *buf;
+  int degree;
+
+  /* each message with the weapon's verb in it is compiled the first time
+     it is needed; plural says which take the "hits" form */
+  static struct act_template *dam_acts[DAM_WEAPONS][DAM_DEGREES][3];
 
   static struct dam_weapon_type {
+    int most;                   /* highest damage for this message */
     char *to_room;
     char *to_char;
     char *to_victim;
-  } dam_weapons[] = {
+    int plural[3];
+  } dam_weapons[DAM_DEGREES] = {
 
     {
-      "$n misses $N with $s #W.",       /*    0    */
-    "You miss $N with your #W.", "$n miss you with $s #W."}, {
-      "$n tickles $N with $s #W.",      /*  1.. 2  */
-    "You tickle $N as you #W $M.", "$n tickle you as $e #W you."}, {
-      "$n barely #W $N.",       /*  3.. 4  */
-    "You barely #W $N.", "$n barely #W you."}, {
-      "$n #W $N.",              /*  5.. 6  */
-    "You #W $N.", "$n #W you."}, {
-      "$n #W $N hard.",         /*  7..10  */
-    "You #W $N hard.", "$n #W you hard."}, {
-      "$n #W $N very hard.",    /* 11..14  */
-    "You #W $N very hard.", "$n #W you very hard."}, {
-      "$n #W $N extremely hard.",       /* 15..20  */
-    "You #W $N extremely hard.", "$n #W you extremely hard."}, {
-      "$n massacre $N to small fragments with $s #W.",  /* > 20    */
-    "You massacre $N to small fragments with your #W.",
-        "$n massacre you to small fragments with $s #W."}
+      0, "$n misses $N with $s #W.",    /*    0    */
+      "You miss $N with your #W.", "$n miss you with $s #W.", {0, 0, 0}}, {
+      2, "$n tickles $N with $s #W.",   /*  1.. 2  */
+      "You tickle $N as you #W $M.", "$n tickle you as $e #W you.",
+    {0, 0, 1}}, {
+      4, "$n barely #W $N.",    /*  3.. 4  */
+    "You barely #W $N.", "$n barely #W you.", {0, 0, 1}}, {
+      6, "$n #W $N.",           /*  5.. 6  */
+    "You #W $N.", "$n #W you.", {1, 0, 1}}, {
+      10, "$n #W $N hard.",     /*  7..10  */
+    "You #W $N hard.", "$n #W you hard.", {1, 0, 0}}, {
+      15, "$n #W $N very hard.",        /* 11..15  */
+    "You #W $N very hard.", "$n #W you very hard.", {1, 0, 1}}, {
+      20, "$n #W $N extremely hard.",   /* 16..20  */
+    "You #W $N extremely hard.", "$n #W you extremely hard.", {0, 0, 0}}, {
+      -1, "$n massacre $N to small fragments with $s #W.",      /* > 20    */
+      "You massacre $N to small fragments with your #W.",
+    "$n massacre you to small fragments with $s #W.", {0, 0, 0}}
   };
+  struct dam_weapon_type *msg;
+  struct act_template **acts;
 
   w_type -= TYPE_HIT;           /* Change to base of table with text */
 
   wield = ch->equipment[WIELD];
 
-  if (dam == 0) {
-    buf =
-      replace_string (dam_weapons[0].to_room,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[0].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[0].to_victim,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else if (dam <= 2) {
-    buf =
-      replace_string (dam_weapons[1].to_room,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[1].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[1].to_victim,
-      attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else if (dam <= 4) {
-    buf =
-      replace_string (dam_weapons[2].to_room,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[2].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[2].to_victim,
-      attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else if (dam <= 6) {
-    buf =
-      replace_string (dam_weapons[3].to_room, attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[3].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[3].to_victim,
-      attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else if (dam <= 10) {
-    buf =
-      replace_string (dam_weapons[4].to_room, attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[4].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[4].to_victim,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else if (dam <= 15) {
-    buf =
-      replace_string (dam_weapons[5].to_room, attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[5].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[5].to_victim,
-      attack_hit_text[w_type].plural);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else if (dam <= 20) {
-    buf =
-      replace_string (dam_weapons[6].to_room,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[6].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[6].to_victim,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
-  } else {
-    buf =
-      replace_string (dam_weapons[7].to_room,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_NOTVICT);
-    buf =
-      replace_string (dam_weapons[7].to_char,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_CHAR);
-    buf =
-      replace_string (dam_weapons[7].to_victim,
-      attack_hit_text[w_type].singular);
-    act (buf, FALSE, ch, wield, victim, TO_VICT);
+  for (degree = 0; degree < DAM_DEGREES - 1 && dam > dam_weapons[degree].most;
+    degree++);
+  msg = &dam_weapons[degree];
+  acts = dam_acts[w_type][degree];
+
+  if (!acts[0]) {
+    acts[0] = act_prepare (replace_string (msg->to_room, msg->plural[0] ?
+        attack_hit_text[w_type].plural : attack_hit_text[w_type].singular));
+    acts[1] = act_prepare (replace_string (msg->to_char, msg->plural[1] ?
+        attack_hit_text[w_type].plural : attack_hit_text[w_type].singular));
+    acts[2] = act_prepare (replace_string (msg->to_victim, msg->plural[2] ?
+        attack_hit_text[w_type].plural : attack_hit_text[w_type].singular));
   }
+
+  act_prepared (acts[0], FALSE, ch, wield, victim, TO_NOTVICT);
+  act_prepared (acts[1], FALSE, ch, wield, victim, TO_CHAR);
+  act_prepared (acts[2], FALSE, ch, wield, victim, TO_VICT);
 }
 
 
@@ -537,8 +491,10 @@ void damage (struct char_data *ch, struct char_data *victim,
   int dam, int attacktype)
 {
   char buf[MAX_STRING_LENGTH];
+  struct message_list *list;
   struct message_type *messages;
-  int i, j, nr, max_hit, exp;
+  struct msg_type *msg;
+  int nr, max_hit, exp;
 
   int hit_limit (struct char_data *ch);
 
@@ -560,7 +516,7 @@ void damage (struct char_data *ch, struct char_data *victim,
 
       if (IS_NPC (ch) && IS_NPC (victim) &&
         victim->master &&
-        !number (0, 10) && IS_AFFECTED (victim, AFF_CHARM) &&
+        !rng_number (RNG_COMBAT, 0, 10) && IS_AFFECTED (victim, AFF_CHARM) &&
         (victim->master->in_room == ch->in_room)) {
         if (ch->specials.fighting)
           stop_fighting (ch);
@@ -584,6 +540,7 @@ void damage (struct char_data *ch, struct char_data *victim,
   dam = MAX (dam, 0);
 
   GET_HIT (victim) -= dam;
+  EVENT (EVENT_DAMAGE, ch, event_id (victim), dam, attacktype);
 
   if (ch != victim)
     gain_exp (ch, GET_LEVEL (victim) * dam);
@@ -598,46 +555,27 @@ void damage (struct char_data *ch, struct char_data *victim,
       dam_message (dam, ch, victim, attacktype);
     }
   } else {
+    if (attacktype >= 0 && attacktype <= fight_max_type &&
+      (list = fight_index[attacktype])) {
+      /* the file's last message for a type is number 1 */
+      nr = rng_dice (RNG_COMBAT, 1, list->number_of_attacks);
+      messages = &list->msg[list->number_of_attacks - nr];
+
+      if (!IS_NPC (victim) && (GET_LEVEL (victim) > 20))
+        msg = &messages->god_msg;
+      else if (dam == 0)
+        msg = &messages->miss_msg;
+      else if (GET_POS (victim) == POSITION_DEAD)
+        msg = &messages->die_msg;
+      else
+        msg = &messages->hit_msg;
 
-    for (i = 0; i < MAX_MESSAGES; i++) {
-      if (fight_messages[i].a_type == attacktype) {
-        nr = dice (1, fight_messages[i].number_of_attacks);
-        for (j = 1, messages = fight_messages[i].msg; (j < nr) && (messages);
-          j++)
-          messages = messages->next;
-
-        if (!IS_NPC (victim) && (GET_LEVEL (victim) > 20)) {
-          act (messages->god_msg.attacker_msg, FALSE, ch,
-            ch->equipment[WIELD], victim, TO_CHAR);
-          act (messages->god_msg.victim_msg, FALSE, ch, ch->equipment[WIELD],
-            victim, TO_VICT);
-          act (messages->god_msg.room_msg, FALSE, ch, ch->equipment[WIELD],
-            victim, TO_NOTVICT);
-        } else if (dam != 0) {
-          if (GET_POS (victim) == POSITION_DEAD) {
-            act (messages->die_msg.attacker_msg, FALSE, ch,
-              ch->equipment[WIELD], victim, TO_CHAR);
-            act (messages->die_msg.victim_msg, FALSE, ch,
-              ch->equipment[WIELD], victim, TO_VICT);
-            act (messages->die_msg.room_msg, FALSE, ch, ch->equipment[WIELD],
-              victim, TO_NOTVICT);
-          } else {
-            act (messages->hit_msg.attacker_msg, FALSE, ch,
-              ch->equipment[WIELD], victim, TO_CHAR);
-            act (messages->hit_msg.victim_msg, FALSE, ch,
-              ch->equipment[WIELD], victim, TO_VICT);
-            act (messages->hit_msg.room_msg, FALSE, ch, ch->equipment[WIELD],
-              victim, TO_NOTVICT);
-          }
-        } else {                /* Dam == 0 */
-          act (messages->miss_msg.attacker_msg, FALSE, ch,
-            ch->equipment[WIELD], victim, TO_CHAR);
-          act (messages->miss_msg.victim_msg, FALSE, ch, ch->equipment[WIELD],
-            victim, TO_VICT);
-          act (messages->miss_msg.room_msg, FALSE, ch, ch->equipment[WIELD],
-            victim, TO_NOTVICT);
-        }
-      }
+      act_prepared (msg->attacker_act, FALSE, ch, ch->equipment[WIELD], victim,
+        TO_CHAR);
+      act_prepared (msg->victim_act, FALSE, ch, ch->equipment[WIELD], victim,
+        TO_VICT);
+      act_prepared (msg->room_act, FALSE, ch, ch->equipment[WIELD], victim,
+        TO_NOTVICT);
     }
   }
   switch (GET_POS (victim)) {
@@ -722,6 +660,7 @@ void damage (struct char_data *ch, struct char_data *victim,
         world[victim->in_room].name);
       log (buf);
     }
+    EVENT (EVENT_KILL, ch, event_id (victim), GET_LEVEL (victim), 0);
     die (victim);
   }
 }
@@ -801,7 +740,7 @@ void hit (struct char_data *ch, struct char_data *victim, int type)
   calc_thaco -= str_app[STRENGTH_APPLY_INDEX (ch)].tohit;
   calc_thaco -= GET_HITROLL (ch);
 
-  diceroll = number (1, 20);
+  diceroll = rng_number (RNG_COMBAT, 1, 20);
 
   victim_ac = GET_AC (victim) / 10;
 
@@ -823,11 +762,13 @@ void hit (struct char_data *ch, struct char_data *victim, int type)
 
     if (!wielded) {
       if (IS_NPC (ch))
-        dam += dice (ch->specials.damnodice, ch->specials.damsizedice);
+        dam += rng_dice (RNG_COMBAT, ch->specials.damnodice,
+          ch->specials.damsizedice);
       else
-        dam += number (0, 2);   /* Max. 2 dam with bare hands */
+        dam += rng_number (RNG_COMBAT, 0, 2);   /* Max. 2 dam with bare hands */
     } else {
-      dam += dice (wielded->obj_flags.value[1], wielded->obj_flags.value[2]);
+      dam += rng_dice (RNG_COMBAT, wielded->obj_flags.value[1],
+        wielded->obj_flags.value[2]);
     }
 
     if (GET_POS (victim) < POSITION_FIGHTING)
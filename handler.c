@@ -20,6 +20,9 @@ extern struct char_data *character_list;
 extern struct index_data *mob_index;
 extern struct index_data *obj_index;
 extern struct descriptor_data *descriptor_list;
+extern struct zone_data *zone_table;
+extern int top_of_zone_table;
+extern struct char_data *zone_next_mob;
 
 /* External procedures */
 
@@ -28,6 +31,11 @@ void free_char (struct char_data *ch);
 void stop_fighting (struct char_data *ch);
 void remove_follower (struct char_data *ch);
 
+/* things whose special procedure special() must offer commands to */
+#define OBJ_LISTENS(obj) \
+  ((obj)->item_number >= 0 && SPEC_LISTENS (obj_index[(obj)->item_number]))
+#define MOB_LISTENS(ch)  (IS_MOB (ch) && SPEC_LISTENS (mob_index[(ch)->nr]))
+
 
 
 char *fname (char *namelist)
@@ -73,6 +81,157 @@ int isname (char *str, char *namelist)
 }
 
 
+/* Matching through keyword sets.  For a purely alphabetic word isname()
+   is true exactly when the word equals, ignoring case, one of the runs
+   of letters it would try in turn: the one at the start of the namelist
+   and each one following the character that ends the run before.  Those
+   runs are hashed once per namelist, so a search through a crowded room
+   compares a hash per word instead of rescanning every namelist.  Other
+   words go to isname() itself. */
+
+struct keyword_query {
+  char *str;
+  unsigned long hash;
+  int length;
+  int plain;                    /* letters only */
+};
+
+static unsigned long keyword_hash (char *str, int length)
+{
+  unsigned long hash = 2166136261UL;
+
+  for (; length-- > 0; str++)
+    hash = ((hash ^ (unsigned char) LOWER (*str)) * 16777619UL) & 0xffffffffUL;
+
+  return (hash);
+}
+
+
+static void keyword_query (struct keyword_query *q, char *str)
+{
+  char *scan;
+
+  for (scan = str; isalpha ((int)*scan); scan++);
+
+  q->str = str;
+  q->length = scan - str;
+  q->plain = (q->length > 0 && !*scan);
+  q->hash = q->plain ? keyword_hash (str, q->length) : 0;
+}
+
+
+void keywords_free (struct keyword_set *set)
+{
+  if (set->word)
+    free (set->word);
+
+  set->source = 0;
+  set->num = 0;
+  set->word = 0;
+}
+
+
+static void keywords_build (struct keyword_set *set, char *namelist)
+{
+  int i, run, size;
+
+  keywords_free (set);
+  set->source = namelist;
+
+  for (i = 0, size = 0;;) {
+    for (run = 0; isalpha ((int)*(namelist + i + run)); run++);
+
+    if (run) {
+      if (set->num >= size) {
+        size = size ? 2 * size : 4;
+        if (set->word)
+          RECREATE (set->word, struct keyword, size);
+        else
+          CREATE (set->word, struct keyword, size);
+      }
+      set->word[set->num].hash = keyword_hash (namelist + i, run);
+      set->word[set->num].offset = i;
+      set->word[set->num].length = run;
+      set->num++;
+    }
+
+    i += run;
+    if (!*(namelist + i))
+      break;
+    i++;
+  }
+}
+
+
+static int keywords_match (struct keyword_query *q, struct keyword_set *set,
+  char *namelist)
+{
+  int i;
+
+  if (!q->plain)
+    return (isname (q->str, namelist));
+
+  if (set->source != namelist)
+    keywords_build (set, namelist);
+
+  for (i = 0; i < set->num; i++)
+    if (set->word[i].hash == q->hash && set->word[i].length == q->length &&
+      !strn_cmp (namelist + set->word[i].offset, q->str, q->length))
+      return (1);
+
+  return (0);
+}
+
+
+/* isname() for the name of an object or character */
+int obj_isname (char *str, struct obj_data *obj)
+{
+  struct keyword_query q;
+
+  keyword_query (&q, str);
+  return (keywords_match (&q, &obj->keywords, obj->name));
+}
+
+
+int char_isname (char *str, struct char_data *ch)
+{
+  struct keyword_query q;
+
+  keyword_query (&q, str);
+  return (keywords_match (&q, &ch->keywords, GET_NAME (ch)));
+}
+
+
+
+/* refresh what ch sees with and what it takes to see ch; call it
+   whenever AFF_BLIND, AFF_INVISIBLE or AFF_DETECT_INVISIBLE may change */
+void update_sight (struct char_data *ch)
+{
+  ch->specials.sight = 0;
+  if (!IS_AFFECTED (ch, AFF_BLIND)) {
+    ch->specials.sight |= SIGHT_EYES;
+    if (IS_AFFECTED (ch, AFF_DETECT_INVISIBLE))
+      ch->specials.sight |= SIGHT_INVISIBLE;
+  }
+
+  ch->specials.visibility = SIGHT_EYES;
+  if (IS_AFFECTED (ch, AFF_INVISIBLE))
+    ch->specials.visibility |= SIGHT_INVISIBLE;
+}
+
+
+/* change the number of light sources in a room, and so its darkness */
+void room_light (int room, int change)
+{
+  world[room].light += change;
+
+  if (!world[room].light && IS_SET (world[room].room_flags, DARK))
+    world[room].visibility = SIGHT_LIGHT;
+  else
+    world[room].visibility = 0;
+}
+
+
 
 void affect_modify (struct char_data *ch, byte loc, byte mod, long bitv,
   bool add)
@@ -86,6 +245,9 @@ void affect_modify (struct char_data *ch, byte loc, byte mod, long bitv,
     mod = -mod;
   }
 
+  if (bitv & (AFF_BLIND | AFF_INVISIBLE | AFF_DETECT_INVISIBLE))
+    update_sight (ch);
+
 
   maxabil = (IS_NPC (ch) ? 25 : 18);
 
@@ -94,23 +256,23 @@ void affect_modify (struct char_data *ch, byte loc, byte mod, long bitv,
     break;
 
   case APPLY_STR:
-    GET_STR (ch) += mod;
+    ch->applied.str += mod;
     break;
 
   case APPLY_DEX:
-    GET_DEX (ch) += mod;
+    ch->applied.dex += mod;
     break;
 
   case APPLY_INT:
-    GET_INT (ch) += mod;
+    ch->applied.intel += mod;
     break;
 
   case APPLY_WIS:
-    GET_WIS (ch) += mod;
+    ch->applied.wis += mod;
     break;
 
   case APPLY_CON:
-    GET_CON (ch) += mod;
+    ch->applied.con += mod;
     break;
 
   case APPLY_SEX:
@@ -195,74 +357,361 @@ void affect_modify (struct char_data *ch, byte loc, byte mod, long bitv,
 
 
 
-/* This updates a character by subtracting everything he is affected by */
-/* restoring original abilities, and then affecting all again           */
-void affect_total (struct char_data *ch)
+/* Removing an affect clears its bits, though something else on ch may
+   still give them; set again whatever the remaining items and spells
+   give. */
+static void affect_bits (struct char_data *ch)
 {
   struct affected_type *af;
-  int i, j;
+  int i;
 
-  for (i = 0; i < MAX_WEAR; i++) {
+  for (i = 0; i < MAX_WEAR; i++)
     if (ch->equipment[i])
-      for (j = 0; j < MAX_OBJ_AFFECT; j++)
-        affect_modify (ch, ch->equipment[i]->affected[j].location,
-          ch->equipment[i]->affected[j].modifier,
-          ch->equipment[i]->obj_flags.bitvector, FALSE);
+      SET_BIT (ch->specials.affected_by,
+        ch->equipment[i]->obj_flags.bitvector);
+
+  for (af = ch->affected; af; af = af->next)
+    SET_BIT (ch->specials.affected_by, af->bitvector);
+
+  update_sight (ch);
+}
+
+
+#ifdef AFFECT_DEBUG
+static void affect_sum (struct char_apply_data *sum, byte loc, byte mod)
+{
+  switch (loc) {
+  case APPLY_STR:
+    sum->str += mod;
+    break;
+  case APPLY_DEX:
+    sum->dex += mod;
+    break;
+  case APPLY_INT:
+    sum->intel += mod;
+    break;
+  case APPLY_WIS:
+    sum->wis += mod;
+    break;
+  case APPLY_CON:
+    sum->con += mod;
+    break;
   }
+}
 
 
-  for (af = ch->affected; af; af = af->next)
-    affect_modify (ch, af->location, af->modifier, af->bitvector, FALSE);
+/* check the applied sums and bits against everything on ch */
+static void affect_verify (struct char_data *ch)
+{
+  struct char_apply_data sum;
+  struct affected_type *af;
+  struct obj_data *obj;
+  char buf[MAX_STRING_LENGTH];
+  long bits = 0;
+  int i, j;
 
-  ch->tmpabilities = ch->abilities;
+  memset (&sum, 0, sizeof (sum));
 
-  for (i = 0; i < MAX_WEAR; i++) {
-    if (ch->equipment[i])
+  for (i = 0; i < MAX_WEAR; i++)
+    if ((obj = ch->equipment[i])) {
+      bits |= obj->obj_flags.bitvector;
       for (j = 0; j < MAX_OBJ_AFFECT; j++)
-        affect_modify (ch, ch->equipment[i]->affected[j].location,
-          ch->equipment[i]->affected[j].modifier,
-          ch->equipment[i]->obj_flags.bitvector, TRUE);
+        affect_sum (&sum, obj->affected[j].location,
+          obj->affected[j].modifier);
+    }
+
+  for (af = ch->affected; af; af = af->next) {
+    bits |= af->bitvector;
+    affect_sum (&sum, af->location, af->modifier);
   }
 
+  if (memcmp (&sum, &ch->applied, sizeof (sum)) ||
+    (ch->specials.affected_by & bits) != bits) {
+    sprintf (buf, "AFFECT: %s has str %d int %d wis %d dex %d con %d "
+      "bits %ld, should be %d %d %d %d %d bits %ld", GET_NAME (ch),
+      ch->applied.str, ch->applied.intel, ch->applied.wis, ch->applied.dex,
+      ch->applied.con, ch->specials.affected_by, sum.str, sum.intel,
+      sum.wis, sum.dex, sum.con, bits);
+    log (buf);
+  }
+}
+#endif
 
-  for (af = ch->affected; af; af = af->next)
-    affect_modify (ch, af->location, af->modifier, af->bitvector, TRUE);
 
-  /* Make certain values are between 0..25, not < 0 and not > 25! */
+/* Work out the abilities ch uses from its own and the modifiers applied
+   to it.  affect_modify() keeps every other apply up to date as it goes;
+   the abilities alone are clamped, so they are rebuilt from the sums. */
+void affect_total (struct char_data *ch)
+{
+  int max, str;
 
-  i = (IS_NPC (ch) ? 25 : 18);
+  max = (IS_NPC (ch) ? 25 : 18);
 
-  GET_DEX (ch) = MAX (0, MIN (GET_DEX (ch), i));
-  GET_INT (ch) = MAX (0, MIN (GET_INT (ch), i));
-  GET_WIS (ch) = MAX (0, MIN (GET_WIS (ch), i));
-  GET_CON (ch) = MAX (0, MIN (GET_CON (ch), i));
-  GET_STR (ch) = MAX (0, GET_STR (ch));
+  GET_DEX (ch) = MAX (0, MIN (ch->abilities.dex + ch->applied.dex, max));
+  GET_INT (ch) = MAX (0, MIN (ch->abilities.intel + ch->applied.intel, max));
+  GET_WIS (ch) = MAX (0, MIN (ch->abilities.wis + ch->applied.wis, max));
+  GET_CON (ch) = MAX (0, MIN (ch->abilities.con + ch->applied.con, max));
+  GET_ADD (ch) = ch->abilities.str_add;
 
-  if (IS_NPC (ch)) {
-    GET_STR (ch) = MIN (GET_STR (ch), i);
-  } else {
-    if (GET_STR (ch) > 18) {
-      i = GET_ADD (ch) + ((GET_STR (ch) - 18) * 10);
-      GET_ADD (ch) = MIN (i, 100);
-      GET_STR (ch) = 18;
+  str = MAX (0, ch->abilities.str + ch->applied.str);
+
+  if (IS_NPC (ch))
+    GET_STR (ch) = MIN (str, max);
+  else if (str > 18) {
+    GET_ADD (ch) = MIN (GET_ADD (ch) + (str - 18) * 10, 100);
+    GET_STR (ch) = 18;
+  } else
+    GET_STR (ch) = str;
+
+#ifdef AFFECT_DEBUG
+  affect_verify (ch);
+#endif
+}
+
+
+
+/* The expiry heaps. Every affect on a char, and every object with a
+   running timer (corpses, burning lights), sits on one of these ordered
+   by the mud hour it runs out, so the hourly updates only touch what
+   actually expires instead of every char and object in the game.        */
+
+struct timer_heap {
+  struct timer_node **node;
+  int top;                      /* Number of timers in the heap */
+  int size;                     /* Allocated slots              */
+};
+
+static struct timer_heap affect_heap = { 0, 0, 0 };
+static struct timer_heap obj_heap = { 0, 0, 0 };
+static long timer_hour = 0;     /* Mud hours since boot */
+static long timer_seq = 0;
+
+/* TRUE if timer a must come off the heap before timer b. Among timers
+   running out in the same hour the newest goes first, which is the order
+   of both ch->affected and object_list.                                  */
+static int timer_before (struct timer_node *a, struct timer_node *b)
+{
+  if (a->expires != b->expires)
+    return (a->expires < b->expires);
+  return (a->seq > b->seq);
+}
+
+static void timer_heap_set (struct timer_heap *h, int pos,
+  struct timer_node *t)
+{
+  h->node[pos] = t;
+  t->heap_pos = pos;
+}
+
+static void timer_heap_up (struct timer_heap *h, int pos)
+{
+  struct timer_node *t = h->node[pos];
+
+  while (pos > 0 && timer_before (t, h->node[(pos - 1) / 2])) {
+    timer_heap_set (h, pos, h->node[(pos - 1) / 2]);
+    pos = (pos - 1) / 2;
+  }
+  timer_heap_set (h, pos, t);
+}
+
+static void timer_heap_down (struct timer_heap *h, int pos)
+{
+  struct timer_node *t = h->node[pos];
+  int child;
+
+  while ((child = 2 * pos + 1) < h->top) {
+    if (child + 1 < h->top && timer_before (h->node[child + 1], h->node[child]))
+      child++;
+    if (!timer_before (h->node[child], t))
+      break;
+    timer_heap_set (h, pos, h->node[child]);
+    pos = child;
+  }
+  timer_heap_set (h, pos, t);
+}
+
+static void timer_heap_insert (struct timer_heap *h, struct timer_node *t,
+  void *owner, long expires)
+{
+  if (h->top >= h->size) {
+    h->size = h->size ? 2 * h->size : 256;
+    RECREATE (h->node, struct timer_node *, h->size);
+  }
+  t->owner = owner;
+  t->expires = expires;
+  t->seq = ++timer_seq;
+  timer_heap_set (h, h->top++, t);
+  timer_heap_up (h, t->heap_pos);
+}
+
+static void timer_heap_delete (struct timer_heap *h, struct timer_node *t)
+{
+  int pos = t->heap_pos;
+
+  t->owner = 0;
+  if (--h->top == pos)
+    return;
+
+  timer_heap_set (h, pos, h->node[h->top]);
+  timer_heap_up (h, pos);
+  timer_heap_down (h, h->node[pos]->heap_pos);
+}
+
+/* Owner of the first timer on the heap if it has run out, else NULL */
+static void *timer_heap_due (struct timer_heap *h)
+{
+  if (!h->top || h->node[0]->expires > timer_hour)
+    return (0);
+  return (h->node[0]->owner);
+}
+
+
+
+/* Advance the timer clock by one mud hour */
+void timer_clock_tick (void)
+{
+  timer_hour++;
+}
+
+
+
+/* Hours left on an affect, as the old per-hour countdown would show it */
+int affect_duration (struct affected_type *af)
+{
+  if (!((struct affect_timer *) af)->node.owner)
+    return (af->duration);
+  return ((int) (((struct affect_timer *) af)->node.expires - timer_hour - 1));
+}
+
+
+
+/* Return an affect that has run out, and the char it is on, or NULL when
+   nothing more is due this hour. The caller must affect_remove() it.    */
+struct affected_type *affect_due (struct char_data **ch)
+{
+  struct affect_timer *timer;
+
+  if (!(timer = (struct affect_timer *) timer_heap_due (&affect_heap)))
+    return (0);
+
+  *ch = timer->ch;
+  return (&timer->af);
+}
+
+
+
+/* TRUE if the affect will still be there after the current hour's update */
+bool affect_outlasts_hour (struct affected_type *af)
+{
+  if (!((struct affect_timer *) af)->node.owner)
+    return (TRUE);
+  return (((struct affect_timer *) af)->node.expires > timer_hour);
+}
+
+
+
+/* Stop the timers of every affect on ch, leaving the hours left in their
+   durations.  A player read from the player file is not in the game yet,
+   and their affects should not run out at the password prompt or menu.  */
+void affect_timers_stop (struct char_data *ch)
+{
+  struct affected_type *af;
+
+  for (af = ch->affected; af; af = af->next)
+    if (((struct affect_timer *) af)->node.owner) {
+      af->duration = affect_duration (af);
+      timer_heap_delete (&affect_heap, &((struct affect_timer *) af)->node);
     }
+}
+
+
+
+/* Start the timers stopped by affect_timers_stop(), as ch enters the game */
+void affect_timers_start (struct char_data *ch)
+{
+  struct affected_type *af;
+
+  for (af = ch->affected; af; af = af->next)
+    if (!((struct affect_timer *) af)->node.owner)
+      timer_heap_insert (&affect_heap, &((struct affect_timer *) af)->node,
+        (struct affect_timer *) af, timer_hour + MAX (af->duration, 0) + 1);
+}
+
+
+
+/* The counter an object's timer runs down: burn time for lights,
+   obj_flags.timer for everything else.                            */
+static int *obj_timer_counter (struct obj_data *obj)
+{
+  if (GET_ITEM_TYPE (obj) == ITEM_LIGHT)
+    return (&obj->obj_flags.value[2]);
+  return (&obj->obj_flags.timer);
+}
+
+
+
+/* Start counting down an object's timer, one step per mud hour */
+void obj_timer_start (struct obj_data *obj)
+{
+  int left = *obj_timer_counter (obj);
+
+  if (obj->timer.owner || left <= 0)
+    return;
+
+  timer_heap_insert (&obj_heap, &obj->timer, obj, timer_hour + left);
+}
+
+
+
+/* While an object's timer runs its counter is not touched; this writes
+   the hours left back into it, for anyone about to look at or save it. */
+void obj_timer_sync (struct obj_data *obj)
+{
+  if (obj->timer.owner)
+    *obj_timer_counter (obj) = (int) (obj->timer.expires - timer_hour);
+}
+
+
+
+/* Stop an object's timer, leaving the hours left in its counter */
+void obj_timer_stop (struct obj_data *obj)
+{
+  if (obj->timer.owner) {
+    obj_timer_sync (obj);
+    timer_heap_delete (&obj_heap, &obj->timer);
   }
 }
 
 
 
+/* Return an object whose timer has run out, or NULL when nothing more is
+   due this hour. The caller must obj_timer_stop() or extract it.        */
+struct obj_data *obj_timer_due (void)
+{
+  return ((struct obj_data *) timer_heap_due (&obj_heap));
+}
+
+
+
 /* Insert an affect_type in a char_data structure
    Automatically sets apropriate bits and apply's */
 void affect_to_char (struct char_data *ch, struct affected_type *af)
 {
   struct affected_type *affected_alloc;
+  struct affect_timer *timer;
 
-  CREATE (affected_alloc, struct affected_type, 1);
+  CREATE (timer, struct affect_timer, 1);
+  affected_alloc = &timer->af;
 
   *affected_alloc = *af;
   affected_alloc->next = ch->affected;
   ch->affected = affected_alloc;
 
+  /* A duration below 1 wears off at the next hourly update */
+  timer->ch = ch;
+  timer_heap_insert (&affect_heap, &timer->node, timer,
+    timer_hour + MAX (af->duration, 0) + 1);
+
   affect_modify (ch, af->location, af->modifier, af->bitvector, TRUE);
   affect_total (ch);
 }
@@ -275,6 +724,7 @@ void affect_to_char (struct char_data *ch, struct affected_type *af)
 void affect_remove (struct char_data *ch, struct affected_type *af)
 {
   struct affected_type *hjp;
+  long bitv;
 
   assert (ch->affected);
 
@@ -300,8 +750,14 @@ void affect_remove (struct char_data *ch, struct affected_type *af)
     hjp->next = af->next;       /* skip the af element */
   }
 
+  if (((struct affect_timer *) af)->node.owner)
+    timer_heap_delete (&affect_heap, &((struct affect_timer *) af)->node);
+  bitv = af->bitvector;
   free (af);
 
+  if (bitv)
+    affect_bits (ch);
+
   affect_total (ch);
 }
 
@@ -344,7 +800,7 @@ void affect_join (struct char_data *ch, struct affected_type *af,
   for (hjp = ch->affected; !found && hjp; hjp = hjp->next) {
     if (hjp->type == af->type) {
 
-      af->duration += hjp->duration;
+      af->duration += affect_duration (hjp);
       if (avg_dur)
         af->duration /= 2;
 
@@ -375,7 +831,7 @@ void char_from_room (struct char_data *ch)
   if (ch->equipment[WEAR_LIGHT])
     if (ch->equipment[WEAR_LIGHT]->obj_flags.type_flag == ITEM_LIGHT)
       if (ch->equipment[WEAR_LIGHT]->obj_flags.value[2])        /* Light is ON */
-        world[ch->in_room].light--;
+        room_light (ch->in_room, -1);
 
   if (ch == world[ch->in_room].people)  /* head of list */
     world[ch->in_room].people = ch->next_in_room;
@@ -388,6 +844,21 @@ void char_from_room (struct char_data *ch)
     i->next_in_room = ch->next_in_room;
   }
 
+  if (MOB_LISTENS (ch))
+    world[ch->in_room].spec_count--;
+
+  if (IS_NPC (ch) && top_of_zone_table >= 0) {
+    if (ch == zone_next_mob)
+      zone_next_mob = ch->next_in_zone;
+    if (ch->prev_in_zone)
+      ch->prev_in_zone->next_in_zone = ch->next_in_zone;
+    else
+      zone_table[world[ch->in_room].zone].mobs = ch->next_in_zone;
+    if (ch->next_in_zone)
+      ch->next_in_zone->prev_in_zone = ch->prev_in_zone;
+    ch->next_in_zone = ch->prev_in_zone = 0;
+  }
+
   ch->in_room = NOWHERE;
   ch->next_in_room = 0;
 }
@@ -402,10 +873,20 @@ void char_to_room (struct char_data *ch, int room)
   world[room].people = ch;
   ch->in_room = room;
 
+  if (MOB_LISTENS (ch))
+    world[room].spec_count++;
+
+  if (IS_NPC (ch) && top_of_zone_table >= 0) {
+    ch->prev_in_zone = 0;
+    if ((ch->next_in_zone = zone_table[world[room].zone].mobs))
+      ch->next_in_zone->prev_in_zone = ch;
+    zone_table[world[room].zone].mobs = ch;
+  }
+
   if (ch->equipment[WEAR_LIGHT])
     if (ch->equipment[WEAR_LIGHT]->obj_flags.type_flag == ITEM_LIGHT)
       if (ch->equipment[WEAR_LIGHT]->obj_flags.value[2])        /* Light is ON */
-        world[room].light++;
+        room_light (room, 1);
 }
 
 
@@ -418,6 +899,9 @@ void obj_to_char (struct obj_data *object, struct char_data *ch)
   object->in_room = NOWHERE;
   IS_CARRYING_W (ch) += GET_OBJ_WEIGHT (object);
   IS_CARRYING_N (ch)++;
+
+  if (OBJ_LISTENS (object))
+    ch->spec_count++;
 }
 
 
@@ -437,6 +921,8 @@ void obj_from_char (struct obj_data *object)
 
   IS_CARRYING_W (object->carried_by) -= GET_OBJ_WEIGHT (object);
   IS_CARRYING_N (object->carried_by)--;
+  if (OBJ_LISTENS (object))
+    object->carried_by->spec_count--;
   object->carried_by = 0;
   object->next_content = 0;
 }
@@ -507,6 +993,8 @@ void equip_char (struct char_data *ch, struct obj_data *obj, int pos)
   }
 
   ch->equipment[pos] = obj;
+  if (OBJ_LISTENS (obj))
+    ch->spec_count++;
 
   if (GET_ITEM_TYPE (obj) == ITEM_ARMOR)
     GET_AC (ch) -= apply_ac (ch, pos);
@@ -515,6 +1003,11 @@ void equip_char (struct char_data *ch, struct obj_data *obj, int pos)
     affect_modify (ch, obj->affected[j].location,
       obj->affected[j].modifier, obj->obj_flags.bitvector, TRUE);
 
+  /* Only players burn down their lights */
+  if ((pos == WEAR_LIGHT) && (GET_ITEM_TYPE (obj) == ITEM_LIGHT) &&
+    !IS_NPC (ch))
+    obj_timer_start (obj);
+
   affect_total (ch);
 }
 
@@ -533,11 +1026,19 @@ struct obj_data *unequip_char (struct char_data *ch, int pos)
     GET_AC (ch) += apply_ac (ch, pos);
 
   ch->equipment[pos] = 0;
+  if (OBJ_LISTENS (obj))
+    ch->spec_count--;
+
+  if (pos == WEAR_LIGHT)
+    obj_timer_stop (obj);
 
   for (j = 0; j < MAX_OBJ_AFFECT; j++)
     affect_modify (ch, obj->affected[j].location,
       obj->affected[j].modifier, obj->obj_flags.bitvector, FALSE);
 
+  if (obj->obj_flags.bitvector)
+    affect_bits (ch);
+
   affect_total (ch);
 
   return (obj);
@@ -574,14 +1075,16 @@ struct obj_data *get_obj_in_list (char *name, struct obj_data *list)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   strcpy (tmpname, name);
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = list, j = 1; i && (j <= number); i = i->next_content)
-    if (isname (tmp, i->name)) {
+    if (keywords_match (&q, &i->keywords, i->name)) {
       if (j == number)
         return (i);
       j++;
@@ -615,14 +1118,16 @@ struct obj_data *get_obj (char *name)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   strcpy (tmpname, name);
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = object_list, j = 1; i && (j <= number); i = i->next)
-    if (isname (tmp, i->name)) {
+    if (keywords_match (&q, &i->keywords, i->name)) {
       if (j == number)
         return (i);
       j++;
@@ -658,14 +1163,16 @@ struct char_data *get_char_room (char *name, int room)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   strcpy (tmpname, name);
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = world[room].people, j = 1; i && (j <= number); i = i->next_in_room)
-    if (isname (tmp, GET_NAME (i))) {
+    if (keywords_match (&q, &i->keywords, GET_NAME (i))) {
       if (j == number)
         return (i);
       j++;
@@ -685,14 +1192,16 @@ struct char_data *get_char (char *name)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   strcpy (tmpname, name);
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = character_list, j = 1; i && (j <= number); i = i->next)
-    if (isname (tmp, GET_NAME (i))) {
+    if (keywords_match (&q, &i->keywords, GET_NAME (i))) {
       if (j == number)
         return (i);
       j++;
@@ -725,6 +1234,9 @@ void obj_to_room (struct obj_data *object, int room)
   world[room].contents = object;
   object->in_room = room;
   object->carried_by = 0;
+
+  if (OBJ_LISTENS (object))
+    world[room].spec_count++;
 }
 
 
@@ -746,11 +1258,28 @@ void obj_from_room (struct obj_data *object)
     i->next_content = object->next_content;
   }
 
+  if (OBJ_LISTENS (object))
+    world[object->in_room].spec_count--;
+
   object->in_room = NOWHERE;
   object->next_content = 0;
 }
 
 
+/* number of objects in a list with a special that answers commands, for
+   callers that move a whole inventory at once */
+int obj_specials (struct obj_data *list)
+{
+  int count = 0;
+
+  for (; list; list = list->next_content)
+    if (OBJ_LISTENS (list))
+      count++;
+
+  return (count);
+}
+
+
 /* put an object in an object (quaint)  */
 void obj_to_obj (struct obj_data *obj, struct obj_data *obj_to)
 {
@@ -822,6 +1351,8 @@ void extract_obj (struct obj_data *obj)
 {
   struct obj_data *temp1, *temp2;
 
+  obj_timer_stop (obj);
+
   if (obj->in_room != NOWHERE)
     obj_from_room (obj);
   else if (obj->carried_by)
@@ -858,37 +1389,6 @@ void extract_obj (struct obj_data *obj)
   free_obj (obj);
 }
 
-void update_object (struct obj_data *obj, int use)
-{
-
-  if (obj->obj_flags.timer > 0)
-    obj->obj_flags.timer -= use;
-  if (obj->contains)
-    update_object (obj->contains, use);
-  if (obj->next_content)
-    update_object (obj->next_content, use);
-}
-
-void update_char_objects (struct char_data *ch)
-{
-
-  int i;
-
-  if (ch->equipment[WEAR_LIGHT])
-    if (ch->equipment[WEAR_LIGHT]->obj_flags.type_flag == ITEM_LIGHT)
-      if (ch->equipment[WEAR_LIGHT]->obj_flags.value[2] > 0)
-        (ch->equipment[WEAR_LIGHT]->obj_flags.value[2])--;
-
-  for (i = 0; i < MAX_WEAR; i++)
-    if (ch->equipment[i])
-      update_object (ch->equipment[i], 2);
-
-  if (ch->carrying)
-    update_object (ch->carrying, 1);
-}
-
-
-
 /* Extract a ch completely from the world, and leave his stuff behind */
 void extract_char (struct char_data *ch)
 {
@@ -948,6 +1448,9 @@ void extract_char (struct char_data *ch)
     } else
       world[ch->in_room].contents = ch->carrying;
 
+    world[ch->in_room].spec_count += obj_specials (ch->carrying);
+    ch->spec_count -= obj_specials (ch->carrying);
+
     /* connect the stuff to the room */
     for (i = ch->carrying; i; i = i->next_content) {
       i->carried_by = 0;
@@ -1025,15 +1528,17 @@ struct char_data *get_char_room_vis (struct char_data *ch, char *name)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   strcpy (tmpname, name);
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = world[ch->in_room].people, j = 1; i && (j <= number);
     i = i->next_in_room)
-    if (isname (tmp, GET_NAME (i)))
+    if (keywords_match (&q, &i->keywords, GET_NAME (i)))
       if (CAN_SEE (ch, i)) {
         if (j == number)
           return (i);
@@ -1053,6 +1558,7 @@ struct char_data *get_char_vis (struct char_data *ch, char *name)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   /* check location */
   if (i = get_char_room_vis (ch, name))
@@ -1062,9 +1568,10 @@ struct char_data *get_char_vis (struct char_data *ch, char *name)
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = character_list, j = 1; i && (j <= number); i = i->next)
-    if (isname (tmp, GET_NAME (i)))
+    if (keywords_match (&q, &i->keywords, GET_NAME (i)))
       if (CAN_SEE (ch, i)) {
         if (j == number)
           return (i);
@@ -1086,14 +1593,16 @@ struct obj_data *get_obj_in_list_vis (struct char_data *ch, char *name,
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   strcpy (tmpname, name);
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   for (i = list, j = 1; i && (j <= number); i = i->next_content)
-    if (isname (tmp, i->name))
+    if (keywords_match (&q, &i->keywords, i->name))
       if (CAN_SEE_OBJ (ch, i)) {
         if (j == number)
           return (i);
@@ -1113,6 +1622,7 @@ struct obj_data *get_obj_vis (struct char_data *ch, char *name)
   int j, number;
   char tmpname[MAX_INPUT_LENGTH];
   char *tmp;
+  struct keyword_query q;
 
   /* scan items carried */
   if (i = get_obj_in_list_vis (ch, name, ch->carrying))
@@ -1126,10 +1636,11 @@ struct obj_data *get_obj_vis (struct char_data *ch, char *name)
   tmp = tmpname;
   if (!(number = get_number (&tmp)))
     return (0);
+  keyword_query (&q, tmp);
 
   /* ok.. no luck yet. scan the entire obj list   */
   for (i = object_list, j = 1; i && (j <= number); i = i->next)
-    if (isname (tmp, i->name))
+    if (keywords_match (&q, &i->keywords, i->name))
       if (CAN_SEE_OBJ (ch, i)) {
         if (j == number)
           return (i);
@@ -5,6 +5,8 @@
 
 /* handling the affected-structures */
 void affect_total (struct char_data *ch);
+void update_sight (struct char_data *ch);
+void room_light (int room, int change);
 void affect_modify (struct char_data *ch, byte loc, byte mod, long bitv,
   bool add);
 void affect_to_char (struct char_data *ch, struct affected_type *af);
@@ -13,11 +15,20 @@ void affect_from_char (struct char_data *ch, byte skill);
 bool affected_by_spell (struct char_data *ch, byte skill);
 void affect_join (struct char_data *ch, struct affected_type *af,
   bool avg_dur, bool avg_mod);
+void timer_clock_tick (void);
+int affect_duration (struct affected_type *af);
+struct affected_type *affect_due (struct char_data **ch);
+bool affect_outlasts_hour (struct affected_type *af);
+void affect_timers_stop (struct char_data *ch);
+void affect_timers_start (struct char_data *ch);
 
 
 /* utility */
 struct obj_data *create_money (int amount);
 int isname (char *str, char *namelist);
+int obj_isname (char *str, struct obj_data *obj);
+int char_isname (char *str, struct char_data *ch);
+void keywords_free (struct keyword_set *set);
 char *fname (char *namelist);
 
 /* ******** objects *********** */
@@ -34,6 +45,7 @@ struct obj_data *get_obj (char *name);
 struct obj_data *get_obj_num (int nr);
 
 void obj_to_room (struct obj_data *object, int room);
+int obj_specials (struct obj_data *list);
 void obj_from_room (struct obj_data *object);
 void obj_to_obj (struct obj_data *obj, struct obj_data *obj_to);
 void obj_from_obj (struct obj_data *obj);
@@ -41,6 +53,11 @@ void object_list_new_owner (struct obj_data *list, struct char_data *ch);
 
 void extract_obj (struct obj_data *obj);
 
+void obj_timer_start (struct obj_data *obj);
+void obj_timer_sync (struct obj_data *obj);
+void obj_timer_stop (struct obj_data *obj);
+struct obj_data *obj_timer_due (void);
+
 /* ******* characters ********* */
 
 struct char_data *get_char_room (char *name, int room);
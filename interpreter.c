@@ -271,6 +271,12 @@ char *command[] = { "north",    /* 1 */
   "gol",
   "wizlist",
   ";",
+  "reload",
+  "snapsho",
+  "snapshot",
+  "copyove",
+  "copyover",                   /* 225 */
+  "logging",
   "\n"
 };
 
@@ -339,13 +345,136 @@ int old_search_block (char *argument, int begin, int length, char **list,
   return (found ? guess : -1);
 }
 
+
+/* The command words are kept in a trie as well, so command_interpreter()
+   need not scan all of command[] for every line typed.  Each node holds
+   the first command whose name starts with the letters on the path to
+   it, which is what old_search_block() would have found. */
+
+struct command_node {
+  char letter;
+  int cmd;                      /* first command with this prefix */
+  int child;                    /* first node one letter on, -1 if none */
+  int sibling;                  /* next node under the same parent */
+};
+
+static struct command_node *command_trie = 0;
+static int command_trie_top = 0;
+
+static int command_node_add (char letter, int cmd)
+{
+  static int size = 0;
+
+  if (command_trie_top >= size) {
+    size = size ? 2 * size : 256;
+    if (command_trie)
+      RECREATE (command_trie, struct command_node, size);
+    else
+      CREATE (command_trie, struct command_node, size);
+  }
+
+  command_trie[command_trie_top].letter = letter;
+  command_trie[command_trie_top].cmd = cmd;
+  command_trie[command_trie_top].child = -1;
+  command_trie[command_trie_top].sibling = -1;
+
+  return (command_trie_top++);
+}
+
+
+static void build_command_trie (void)
+{
+  int cmd, node, next;
+  char *word;
+
+  command_trie_top = 0;
+  command_node_add ('\0', 0);   /* root */
+
+  for (cmd = 0; *command[cmd] != '\n'; cmd++)
+    for (node = 0, word = command[cmd]; *word; word++, node = next) {
+      for (next = command_trie[node].child; next != -1;
+        next = command_trie[next].sibling)
+        if (command_trie[next].letter == *word)
+          break;
+
+      if (next == -1) {
+        /* commands are added in table order, so whoever makes a node
+           first is the one an abbreviation should find */
+        next = command_node_add (*word, cmd + 1);
+        command_trie[next].sibling = command_trie[node].child;
+        command_trie[node].child = next;
+      }
+    }
+}
+
+
+/* Same result as old_search_block (argument, begin, length, command, 0) */
+int search_command (char *argument, int begin, int length)
+{
+  int node, search;
+
+  if (length < 1)
+    return (0);
+
+  for (node = 0, search = 0; search < length; search++) {
+    for (node = command_trie[node].child; node != -1;
+      node = command_trie[node].sibling)
+      if (command_trie[node].letter == *(argument + begin + search))
+        break;
+
+    if (node == -1)
+      return (-1);
+  }
+
+  return (command_trie[node].cmd);
+}
+
+
+#ifdef COMMAND_DEBUG
+/* check the trie against old_search_block() for every prefix of every
+   command, and for each prefix followed by a letter no command has */
+static void command_verify (void)
+{
+  char word[MAX_INPUT_LENGTH], buf[MAX_STRING_LENGTH];
+  int cmd, length, bad = 0;
+
+  for (cmd = 0; *command[cmd] != '\n'; cmd++)
+    for (length = 0; length <= (int) strlen (command[cmd]) &&
+      length < MAX_INPUT_LENGTH - 1; length++) {
+      strncpy (word, command[cmd], length);
+      word[length] = '#';
+      word[length + 1] = '\0';
+
+      if (old_search_block (word, 0, length, command, 0) !=
+        search_command (word, 0, length) ||
+        old_search_block (word, 0, length + 1, command, 0) !=
+        search_command (word, 0, length + 1)) {
+        sprintf (buf, "COMMAND: '%.*s' is not found as the old search "
+          "finds it.", length, word);
+        log (buf);
+        bad++;
+      }
+    }
+
+  if (!bad)
+    log ("COMMAND: trie agrees with the old search.");
+}
+#endif
+
+
 void command_interpreter (struct char_data *ch, char *argument)
 {
   int look_at, cmd, begin;
+  char buf[MAX_INPUT_LENGTH + 40];
   extern int no_specials;
 
   REMOVE_BIT (ch->specials.affected_by, AFF_HIDE);
 
+  if (!IS_NPC (ch) && IS_SET (ch->specials.act, PLR_LOG)) {
+    sprintf (buf, "%s: %.*s", GET_NAME (ch), MAX_INPUT_LENGTH, argument);
+    log_at (LOG_COMMANDS, LOG_INFO, buf);
+  }
+
   /* Find first non blank */
   for (begin = 0; (*(argument + begin) == ' '); begin++);
 
@@ -356,7 +485,7 @@ void command_interpreter (struct char_data *ch, char *argument)
     *(argument + begin + look_at) = LOWER (*(argument + begin + look_at));
 
 
-  cmd = old_search_block (argument, begin, look_at, command, 0);
+  cmd = search_command (argument, begin, look_at);
 
 
   if (!cmd)
@@ -560,6 +689,25 @@ void half_chop (char *string, char *arg1, char *arg2)
 
 
 
+/* is the special procedure of an index entry interested in cmd? */
+static int spec_answers (struct index_data *index, int cmd)
+{
+  int *c;
+
+  if (!index->func)
+    return (FALSE);
+
+  if (!index->cmds)
+    return (TRUE);
+
+  for (c = index->cmds; *c; c++)
+    if (*c == cmd)
+      return (TRUE);
+
+  return (FALSE);
+}
+
+
 int special (struct char_data *ch, int cmd, char *arg)
 {
   register struct obj_data *i;
@@ -571,35 +719,38 @@ int special (struct char_data *ch, int cmd, char *arg)
     if ((*world[ch->in_room].funct) (ch, cmd, arg))
       return (1);
 
-  /* special in equipment list? */
-  for (j = 0; j <= (MAX_WEAR - 1); j++)
-    if (ch->equipment[j] && ch->equipment[j]->item_number >= 0)
-      if (obj_index[ch->equipment[j]->item_number].func)
-        if ((*obj_index[ch->equipment[j]->item_number].func)
-          (ch, cmd, arg))
-          return (1);
-
-  /* special in inventory? */
-  for (i = ch->carrying; i; i = i->next_content)
-    if (i->item_number >= 0)
-      if (obj_index[i->item_number].func)
-        if ((*obj_index[i->item_number].func) (ch, cmd, arg))
-          return (1);
-
-  /* special in mobile present? */
-  for (k = world[ch->in_room].people; k; k = k->next_in_room)
-    if (IS_MOB (k))
-      if (mob_index[k->nr].func)
-        if ((*mob_index[k->nr].func) (ch, cmd, arg))
-          return (1);
-
-  /* special in object present? */
-  for (i = world[ch->in_room].contents; i; i = i->next_content)
-    if (i->item_number >= 0)
-      if (obj_index[i->item_number].func)
-        if ((*obj_index[i->item_number].func) (ch, cmd, arg))
-          return (1);
+  if (ch->spec_count) {
+    /* special in equipment list? */
+    for (j = 0; j <= (MAX_WEAR - 1); j++)
+      if (ch->equipment[j] && ch->equipment[j]->item_number >= 0)
+        if (spec_answers (&obj_index[ch->equipment[j]->item_number], cmd))
+          if ((*obj_index[ch->equipment[j]->item_number].func)
+            (ch, cmd, arg))
+            return (1);
+
+    /* special in inventory? */
+    for (i = ch->carrying; i; i = i->next_content)
+      if (i->item_number >= 0)
+        if (spec_answers (&obj_index[i->item_number], cmd))
+          if ((*obj_index[i->item_number].func) (ch, cmd, arg))
+            return (1);
+  }
 
+  if (world[ch->in_room].spec_count) {
+    /* special in mobile present? */
+    for (k = world[ch->in_room].people; k; k = k->next_in_room)
+      if (IS_MOB (k))
+        if (spec_answers (&mob_index[k->nr], cmd))
+          if ((*mob_index[k->nr].func) (ch, cmd, arg))
+            return (1);
+
+    /* special in object present? */
+    for (i = world[ch->in_room].contents; i; i = i->next_content)
+      if (i->item_number >= 0)
+        if (spec_answers (&obj_index[i->item_number], cmd))
+          if ((*obj_index[i->item_number].func) (ch, cmd, arg))
+            return (1);
+  }
 
   return (0);
 }
@@ -831,7 +982,18 @@ void assign_command_pointers (void)
   COMMANDO (218, POSITION_DEAD, do_log, 24);
   COMMANDO (219, POSITION_DEAD, do_wizlist, 0);
   COMMANDO (220, POSITION_DEAD, do_wiz, 21);
-
+  COMMANDO (221, POSITION_DEAD, do_reload, 24);
+  COMMANDO (222, POSITION_DEAD, do_snapsho, 24);
+  COMMANDO (223, POSITION_DEAD, do_snapshot, 24);
+  COMMANDO (224, POSITION_DEAD, do_copyove, 24);
+  COMMANDO (225, POSITION_DEAD, do_copyover, 24);
+  COMMANDO (226, POSITION_DEAD, do_logging, 24);
+
+  build_command_trie ();
+
+#ifdef COMMAND_DEBUG
+  command_verify ();
+#endif
 }
 
 /* *************************************************************************
@@ -1004,14 +1166,17 @@ void nanny (struct descriptor_data *d, char *arg)
           act ("$n has reconnected.", TRUE, tmp_ch, 0, 0, TO_ROOM);
           sprintf (buf, "%s[%s] has reconnected.", GET_NAME (d->character),
             d->host);
-          log (buf);
+          log_at (LOG_CONNECT, LOG_INFO, buf);
+          EVENT (EVENT_LOGIN, tmp_ch, 0, GET_LEVEL (tmp_ch), EV_LOGIN_BACK);
           return;
         }
 
 
       sprintf (buf, "%s[%s] has connected.", GET_NAME (d->character),
         d->host);
-      log (buf);
+      log_at (LOG_CONNECT, LOG_INFO, buf);
+      EVENT (EVENT_LOGIN, d->character, 0, GET_LEVEL (d->character),
+        EV_LOGIN_OLD);
 
       SEND_TO_Q (motd, d);
       SEND_TO_Q ("\n\r\n*** PRESS RETURN: ", d);
@@ -1145,7 +1310,9 @@ void nanny (struct descriptor_data *d, char *arg)
       if (STATE (d) != CON_QCLASS) {
         sprintf (buf, "%s [%s] new player.", GET_NAME (d->character),
           d->host);
-        log (buf);
+        log_at (LOG_CONNECT, LOG_INFO, buf);
+        EVENT (EVENT_LOGIN, d->character, 0, GET_LEVEL (d->character),
+          EV_LOGIN_NEW);
       }
     }
     break;
@@ -1173,6 +1340,7 @@ void nanny (struct descriptor_data *d, char *arg)
       send_to_char (WELC_MESSG, d->character);
       d->character->next = character_list;
       character_list = d->character;
+      affect_timers_start (d->character);
       if (d->character->in_room == NOWHERE)
         char_to_room (d->character, real_room (3001));
       else {
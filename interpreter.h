@@ -7,6 +7,7 @@ extern void command_interpreter (struct char_data *ch, char *argument);
 extern int search_block (char *arg, char **list, bool exact);
 extern int old_search_block (char *argument, int begin, int length, char **list,
   int mode);
+extern int search_command (char *argument, int begin, int length);
 extern char lower (char c);
 extern void argument_interpreter (char *argument, char *first_arg, char *second_arg);
 extern char *one_argument (char *argument, char *first_arg);
@@ -132,3 +133,9 @@ extern void do_noemote (struct char_data *ch, char *argument, int cmd);
 extern void do_freeze (struct char_data *ch, char *arg, int cmd);
 extern void do_log (struct char_data *ch, char *arg, int cmd);
 extern void do_wiz (struct char_data *ch, char *argument, int cmd);
+extern void do_reload (struct char_data *ch, char *argument, int cmd);
+extern void do_snapsho (struct char_data *ch, char *argument, int cmd);
+extern void do_snapshot (struct char_data *ch, char *argument, int cmd);
+extern void do_copyove (struct char_data *ch, char *argument, int cmd);
+extern void do_copyover (struct char_data *ch, char *argument, int cmd);
+extern void do_logging (struct char_data *ch, char *argument, int cmd);
@@ -332,6 +332,9 @@ void gain_exp (struct char_data *ch, int gain)
         GET_EXP (ch) = 0;
     }
 
+    if (gain)
+      EVENT (EVENT_EXP, ch, 0, gain, GET_EXP (ch));
+
     if (is_altered)
       set_title (ch);
   }
@@ -442,10 +445,9 @@ void check_idling (struct char_data *ch)
 /* Update both PC's & NPC's and objects*/
 void point_update (void)
 {
-  void update_char_objects (struct char_data *ch);      /* handler.c */
   void extract_obj (struct obj_data *obj);      /* handler.c */
   struct char_data *i, *next_dude;
-  struct obj_data *j, *next_thing, *jj, *next_thing2;
+  struct obj_data *j, *jj, *next_thing2;
 
   /* characters */
   for (i = character_list; i; i = next_dude) {
@@ -464,7 +466,6 @@ void point_update (void)
     else if (!IS_NPC (i) && (GET_POS (i) == POSITION_MORTALLYW))
       damage (i, i, 2, TYPE_SUFFERING);
     if (!IS_NPC (i)) {
-      update_char_objects (i);
       if (GET_LEVEL (i) < 22)
         check_idling (i);
     }
@@ -473,43 +474,36 @@ void point_update (void)
     gain_condition (i, THIRST, -1);
   }                             /* for */
 
-  /* objects */
-  for (j = object_list; j; j = next_thing) {
-    next_thing = j->next;       /* Next in object list */
+  /* objects whose timer ran out; lights just burn out */
+  while ((j = obj_timer_due ())) {
+    obj_timer_stop (j);
 
     /* If this is a corpse */
     if ((GET_ITEM_TYPE (j) == ITEM_CONTAINER) && (j->obj_flags.value[3])) {
-      /* timer count down */
-      if (j->obj_flags.timer > 0)
-        j->obj_flags.timer--;
-
-      if (!j->obj_flags.timer) {
-
-        if (j->carried_by)
-          act ("$p decay in your hands.", FALSE, j->carried_by, j, 0,
-            TO_CHAR);
-        else if ((j->in_room != NOWHERE) && (world[j->in_room].people)) {
-          act ("A quivering hoard of maggots consume $p.",
-            TRUE, world[j->in_room].people, j, 0, TO_ROOM);
-          act ("A quivering hoard of maggots consume $p.",
-            TRUE, world[j->in_room].people, j, 0, TO_CHAR);
-        }
+      if (j->carried_by)
+        act ("$p decay in your hands.", FALSE, j->carried_by, j, 0,
+          TO_CHAR);
+      else if ((j->in_room != NOWHERE) && (world[j->in_room].people)) {
+        act ("A quivering hoard of maggots consume $p.",
+          TRUE, world[j->in_room].people, j, 0, TO_ROOM);
+        act ("A quivering hoard of maggots consume $p.",
+          TRUE, world[j->in_room].people, j, 0, TO_CHAR);
+      }
 
-        for (jj = j->contains; jj; jj = next_thing2) {
-          next_thing2 = jj->next_content;       /* Next in inventory */
-          obj_from_obj (jj);
-
-          if (j->in_obj)
-            obj_to_obj (jj, j->in_obj);
-          else if (j->carried_by)
-            obj_to_room (jj, j->carried_by->in_room);
-          else if (j->in_room != NOWHERE)
-            obj_to_room (jj, j->in_room);
-          else
-            assert (FALSE);
-        }
-        extract_obj (j);
+      for (jj = j->contains; jj; jj = next_thing2) {
+        next_thing2 = jj->next_content;       /* Next in inventory */
+        obj_from_obj (jj);
+
+        if (j->in_obj)
+          obj_to_obj (jj, j->in_obj);
+        else if (j->carried_by)
+          obj_to_room (jj, j->carried_by->in_room);
+        else if (j->in_room != NOWHERE)
+          obj_to_room (jj, j->in_room);
+        else
+          assert (FALSE);
       }
+      extract_obj (j);
     }
   }
 }
@@ -864,7 +864,7 @@ void spell_locate_object (int level, struct char_data *ch,
   j = level >> 1;
 
   for (i = object_list; i && (j > 0); i = i->next)
-    if (isname (name, i->name)) {
+    if (obj_isname (name, i)) {
       if (i->carried_by) {
         sprintf (buf, "%s carried by %s.\n\r",
           i->short_description, PERS (i->carried_by, ch));
@@ -13,6 +13,9 @@
 
 #include "os.h"
 #include "maildef.h"
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
 #ifndef SEEK_SET
 #define SEEK_SET 0
 #define SEEK_CUR 1
@@ -20,10 +23,33 @@
 #endif
 
 
-struct mail_index_struct *mail_index;
-struct free_list_struct *free_list;
+/* The mailfile is mapped into memory as mail_map, which is mail_size bytes
+  long; the blocks in use, or free for reuse, end at end_of_file and the
+  rest of the map is room to grow.  free_map has a bit set for each free
+  block below end_of_file, and prev_block the offset of the block before
+  each data block in its mail.  Under Windows the map is a copy in memory
+  and every change is written through to the file. */
+
+struct mail_index_struct *mail_hash[MAIL_HASH_SIZE];
 long end_of_file;
-FILE *mailfp;
+char *mailfile = MAILFILE;
+
+static char *mail_map = NULL;
+static long mail_size = 0L;
+static unsigned char *free_map = NULL;
+static long *prev_block = NULL;
+static long first_free = 0L;    /* no free block before this one */
+#ifdef WIN32
+static FILE *mailfp = NULL;
+#else
+static int mailfd = -1;
+#endif
+
+#define BLOCK(offset) (mail_map + (offset))
+#define BLOCKNR(offset) ((offset) / BLOCKSIZE)
+#define IS_FREE(nr) (free_map[(nr) >> 3] & (1 << ((nr) & 7)))
+#define SET_FREE(nr) (free_map[(nr) >> 3] |= (1 << ((nr) & 7)))
+#define SET_USED(nr) (free_map[(nr) >> 3] &= ~(1 << ((nr) & 7)))
 
 
 void *mymalloc (size)
@@ -37,21 +63,11 @@ int size;
 }
 
 
-struct free_list_struct *new_free (offset)
-long offset;
-{
-  struct free_list_struct *p;
-  p = (struct free_list_struct *) mymalloc (FREESIZE);
-  p->zero_offset = offset;
-  return p;
-}
-
-
 struct mail_offset_struct *new_offset ()
 {
   struct mail_offset_struct *p;
   p = (struct mail_offset_struct *) mymalloc (OFFSETSIZE);
-  p->mail_header_offset = 1L;   /* 1 lr knappast bli en vanlig blocksize */
+  p->mail_header_offset = 1L;   /* 1 lr knappast bli en vanlig blocksize */
   p->my_next_mail = NULL;
   return p;
 }
@@ -68,118 +84,199 @@ struct mail_offset_struct *first;
 }
 
 
+static int hash_name (name)
+char *name;
+{
+  unsigned long hash = 2166136261UL;
+  int i;
+
+  for (i = 0; i < NAMESIZE && name[i]; i++)
+    hash = ((hash ^ (unsigned char) name[i]) * 16777619UL) & 0xffffffffUL;
+  return (int) (hash % MAIL_HASH_SIZE);
+}
+
+
 struct mail_index_struct *get_index_pos (name)
 char name[NAMESIZE];
 {
-
-  extern struct mail_index_struct *mail_index;
   struct mail_index_struct *cur;
-  cur = mail_index;
-  do {
-    if (!strcmp (cur->to, name))
+
+  for (cur = mail_hash[hash_name (name)]; cur != NULL; cur = cur->next)
+    if (!strncmp (cur->to, name, NAMESIZE))
       return cur;
-  }
-  while ((cur = cur->next) != NULL);
   return NULL;
 }
 
 
-void add_free (offset, p)
+static long next_of (offset)
 long offset;
-struct free_list_struct *p;
 {
+  long next;
+  memcpy (&next, BLOCK (offset) + BLOCK_NEXT, LONGSIZE);
+  return next;
+}
 
-  struct free_list_struct *new = new_free (offset);
 
-  while (p->next != NULL && offset > p->next->zero_offset)
-    p = p->next;
-  if (offset && offset == p->next->zero_offset) {
-    fprintf (stderr, "Error. Trying to add free offset %u twice. Ignored.\n",
-      offset);
-    free (new);
-    return;
-  }
-  new->next = p->next;
-  p->next = new;
-  return;
+static void set_next (offset, next)
+long offset, next;
+{
+  memcpy (BLOCK (offset) + BLOCK_NEXT, &next, LONGSIZE);
 }
 
 
-int add_free_list (offset)
+/* Write a changed block through to the file, where it isn't mapped */
+static void sync_block (offset)
 long offset;
 {
-  extern FILE *mailfp;
-  extern struct free_list_struct *free_list;
-  unsigned int blocks = 0;
+#ifdef WIN32
+  fseek (mailfp, offset, SEEK_SET);
+  if (fwrite (BLOCK (offset), BLOCKSIZE, 1, mailfp) != 1)
+    fprintf (stderr, "Fwrite at fpos %ld failed.\n", offset);
+  fflush (mailfp);
+#endif
+}
 
-  char the_mean_byte = '\0';
 
-  if (offset == 0) {
-    rewind (mailfp);
-    fwrite (&the_mean_byte, CHARSIZE, 1, mailfp);
-    add_free (offset, free_list);
-    fseek (mailfp, DATABLOCKSIZE, SEEK_CUR);
-    fread (&offset, LONGSIZE, 1, mailfp);
-    blocks++;
+/* Make the map size bytes long, and the tables to go with it */
+static int resize_map (size)
+long size;
+{
+  long blocks = BLOCKNR (size), old_blocks = BLOCKNR (mail_size), i;
+  char *map;
+
+#ifdef WIN32
+  if ((map = (char *) realloc (mail_map, size)) == NULL) {
+    fprintf (stderr, "Couldn't map %ld bytes of mailfile.\n", size);
+    return 0;
   }
-  while (offset != NULL && offset != 1) {
-    fseek (mailfp, offset, SEEK_SET);
-    fwrite (&the_mean_byte, CHARSIZE, 1, mailfp);
-    add_free (offset, free_list);
-    fseek (mailfp, DATABLOCKSIZE, SEEK_CUR);
-    fread (&offset, LONGSIZE, 1, mailfp);
-    blocks++;
+  if (size > mail_size)
+    memset (map + mail_size, '\0', size - mail_size);
+#else
+  if (ftruncate (mailfd, size) < 0) {
+    perror ("Resizing mailfile");
+    return 0;
   }
-  return blocks;
+  if (mail_map != NULL)
+    munmap (mail_map, mail_size);
+  map = (char *) mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+    mailfd, 0L);
+  if (map == (char *) MAP_FAILED) {
+    perror ("Mapping mailfile");
+    mail_map = NULL;
+    return 0;
+  }
+#endif
+  mail_map = map;
+  mail_size = size;
+
+  free_map = (unsigned char *) realloc (free_map, blocks / 8 + 1);
+  prev_block = (long *) realloc (prev_block, (blocks + 1) * LONGSIZE);
+  if (free_map == NULL || prev_block == NULL) {
+    fprintf (stderr, "Couldn't allocate mail block tables.\n");
+    return 0;
+  }
+  for (i = old_blocks; i < blocks; i++) {
+    SET_USED (i);
+    prev_block[i] = -1L;
+  }
+  return 1;
 }
 
 
-long get_free_offset ()
+/* The first free block from block nr on, or -1 if there is none */
+static long find_free (nr)
+long nr;
 {
+  long b, end = BLOCKNR (end_of_file);
+
+  for (b = (nr > first_free ? nr : first_free); b < end; b++) {
+    if (!(b & 7) && !free_map[b >> 3]) {
+      b += 7;
+      continue;
+    }
+    if (IS_FREE (b))
+      break;
+  }
+  if (nr <= first_free)
+    first_free = b;
+  return (b < end ? b : -1L);
+}
 
-  extern struct free_list_struct *free_list;
-  struct free_list_struct *p = free_list->next;
-  long ret = 1L;
 
-  if (p != NULL) {
-    free_list->next = p->next;
-    ret = p->zero_offset;
-    free (p);
+/* The offset of a block to write, a free one if there is one or else one
+  more at the end of the file.  Data blocks never go at offset 0. */
+static long new_block (data)
+int data;
+{
+  long b, offset;
+
+  if ((b = find_free (data ? 1L : 0L)) >= 0) {
+    SET_USED (b);
+    return b * BLOCKSIZE;
   }
-  return ret;
+
+  if (end_of_file + BLOCKSIZE > mail_size &&
+    !resize_map (mail_size * 2))
+    return -1L;
+
+  offset = end_of_file;
+  end_of_file += BLOCKSIZE;
+  return offset;
+}
+
+
+static void free_block (offset)
+long offset;
+{
+  long nr = BLOCKNR (offset);
+
+  *BLOCK (offset) = MAIL_FREE;
+  sync_block (offset);
+  SET_FREE (nr);
+  prev_block[nr] = -1L;
+  if (nr < first_free)
+    first_free = nr;
 }
 
 
-/* The first element in mail_index only works as a pointer to the next one */
+/* Free all the blocks of the mail starting at offset */
+unsigned int add_free_list (offset)
+long offset;
+{
+  unsigned int blocks = 0;
+  long next;
+
+  do {
+    next = next_of (offset);
+    free_block (offset);
+    blocks++;
+  } while ((offset = next) != 0 && offset < end_of_file);
+  return blocks;
+}
+
+
+/* Mails to a player are kept in the order they came */
 
 void add_mail (to, from, offset)
 char to[NAMESIZE], from[NAMESIZE];
 long offset;
 {
-
-  extern struct mail_index_struct *mail_index;
-  struct mail_index_struct *mi = mail_index;
+  struct mail_index_struct *mi;
   struct mail_offset_struct *mo;
 
-  /*
-     if (offset % BLOCKSIZE) {
-   */
   if (offset % BLOCKSIZE) {
     fprintf (stderr, "Offset value/Blocksize mismatch.\n");
     return;
   }
-  while (strncmp (mi->to, to, NAMESIZE)) {      /* Check for name in index list */
-    if (mi->next == NULL) {     /* else create new index-element */
-      mi = (mi->next = new_index (new_offset ()));
-      strncpy (mi->to, to, NAMESIZE);
-      break;
-    }
-    mi = mi->next;
-  }
-  mo = mi->my_first_mail;
-  if (mo->mail_header_offset != 1) {
-    while (mo->my_next_mail != NULL)
-      mo = mo->my_next_mail;
+  if ((mi = get_index_pos (to)) == NULL) {
+    mi = new_index (new_offset ());
+    strncpy (mi->to, to, NAMESIZE);
+    mi->next = mail_hash[hash_name (to)];
+    mail_hash[hash_name (to)] = mi;
+    mo = mi->my_first_mail;
+  } else {
+    for (mo = mi->my_first_mail; mo->my_next_mail != NULL;
+      mo = mo->my_next_mail);
     mo = (mo->my_next_mail = new_offset ());
   }
   strncpy (mo->from, from, NAMESIZE);
@@ -195,59 +292,34 @@ long offset;
   there's no immediate need to disable the mailsystem should it return
   a NULL value. */
 
-
 int remove_offset (cur_ind, cur_off)
-
 struct mail_index_struct *cur_ind;
 struct mail_offset_struct *cur_off;
-
 {
-  extern struct mail_index_struct *mail_index;
-  extern struct free_list_struct *free_list;
-  struct mail_index_struct *pmi;
-  struct mail_offset_struct *p;
-  p = cur_ind->my_first_mail;
-  while (p != cur_off) {
-    if (p == NULL) {
+  struct mail_index_struct **pmi;
+  struct mail_offset_struct **p;
+
+  for (p = &cur_ind->my_first_mail; *p != cur_off; p = &(*p)->my_next_mail)
+    if (*p == NULL) {
       fprintf (stderr, "Element to remove not found in list.\n");
-      return NULL;
-    }
-    p = p->my_next_mail;
-  }
-  if (cur_off == cur_ind->my_first_mail) {
-    if (cur_off->my_next_mail == NULL) {
-      pmi = mail_index;
-      while (pmi->next != cur_ind) {
-        if (pmi->next == NULL) {
-          fprintf (stderr, "Mail index list element not found.\n");
-          return NULL;
-        }
-        pmi = pmi->next;
-      }
-      add_free_list (cur_off->mail_header_offset);
-      free (cur_off);
-      pmi->next = cur_ind->next;
-      free (cur_ind);
-      return 2;                 /* cur_ind removed */
-    } else {
-      cur_ind->my_first_mail = cur_off->my_next_mail;
-      add_free_list (cur_off->mail_header_offset);
-      free (cur_off);
-      return 1;                 /* cur_off removed */
-    }
-  }
-  p = cur_ind->my_first_mail;
-  while (p->my_next_mail != cur_off) {
-    if (p->my_next_mail == NULL) {
-      fprintf (stderr, "Unable to find element to remove in list.\n");
-      return NULL;
+      return 0;
     }
-    p = p->my_next_mail;
-  }
-  p->my_next_mail = cur_off->my_next_mail;
+  *p = cur_off->my_next_mail;
   add_free_list (cur_off->mail_header_offset);
   free (cur_off);
-  return 1;                     /* cur_off removed (yet another time..) */
+
+  if (cur_ind->my_first_mail != NULL)
+    return 1;                   /* cur_off removed */
+
+  for (pmi = &mail_hash[hash_name (cur_ind->to)]; *pmi != cur_ind;
+    pmi = &(*pmi)->next)
+    if (*pmi == NULL) {
+      fprintf (stderr, "Mail index list element not found.\n");
+      return 0;
+    }
+  *pmi = cur_ind->next;
+  free (cur_ind);
+  return 2;                     /* cur_ind removed */
 }
 
 
@@ -260,64 +332,47 @@ struct mail_offset_struct *cur_off;
 char *read_delete (recipient)
 char recipient[NAMESIZE];
 {
-
-  extern FILE *mailfp;
   struct mail_index_struct *pi;
   struct mail_offset_struct *po;
-  struct dblock dbl;
-  struct head_block hbl;
   static char *text;
-  char block[DATABLOCKSIZE];
-  long gobbledigook;
-
-  free (text);
-  text = (char *) mymalloc ((gobbledigook = HEADBLOCKSIZE + NAMESIZE + 50));
-  memset (text, '\0', gobbledigook);
+  long offset, length, stamp;
+  time_t date;
 
   if ((pi = get_index_pos (recipient)) == NULL) {
     fprintf (stderr, "Probably-stupid-postoffice-creator bug.\n");
     return "This mail seems to be anonymous and with no text..?";
   }
-  dbl.offset = NULL;
   if ((po = pi->my_first_mail) == NULL) {
     fprintf (stderr, "Mysterious-and-annoying-little-bug error.\n");
     return "You notice this mail has been eaten by a bug!";
   }
-  if ((mailfp = fopen (MAILFILE, "rb+")) == NULL) {
-    fprintf (stderr, "2 Couldn't open mailfile %s\n", MAILFILE);
-    return "Isn't it frustrating when they use invisible ink..?";
-  }
-  fseek (mailfp, po->mail_header_offset, SEEK_SET);
-  fread (&hbl, BLOCKSIZE, 1, mailfp);
-  if (hbl.the_mean_byte != 1) {
+  offset = po->mail_header_offset;
+  if (offset >= end_of_file || *BLOCK (offset) != MAIL_HEAD) {
     fprintf (stderr, "Wrong header block position or corrupt header (%d)\n",
-      hbl.the_mean_byte);
+      offset < end_of_file ? *BLOCK (offset) : -1);
     return NULL;
   }
-  sprintf (text, "Mail from %s, posted %s\n", po->from, ctime (&(hbl.date)));
-  strncat (text, hbl.msg, HEADBLOCKSIZE);
-  if (hbl.offset != NULL) {
-    fseek (mailfp, hbl.offset, SEEK_SET);
-    do {
-      if (dbl.offset && dbl.offset >= end_of_file) {
-        fprintf (stderr, "Attempt to read past EOF: stupid Groo error..\n");
-        return NULL;
-      }
-      dbl.offset = NULL;
-      fread (&dbl, BLOCKSIZE, 1, mailfp);
-      if ((text = (char *) realloc (text,
-            (gobbledigook + DATABLOCKSIZE))) == NULL) {
-        fprintf (stderr, "Couldn't realloc %d more bytes for mail.\n",
-          DATABLOCKSIZE);
-        free (text);
-        return NULL;
-      }
-      gobbledigook += DATABLOCKSIZE;
-      strncat (text, dbl.msg, DATABLOCKSIZE);
-      fseek (mailfp, dbl.offset, SEEK_SET);
+
+  /* Count the blocks first, to get the text in one piece */
+  for (length = HEADBLOCKSIZE + NAMESIZE + 50;
+    (offset = next_of (offset)) != 0; length += DATABLOCKSIZE)
+    if (offset >= end_of_file || *BLOCK (offset) != MAIL_DATA) {
+      fprintf (stderr, "Attempt to read past EOF: stupid Groo error..\n");
+      return NULL;
     }
-    while (dbl.offset != NULL);
-  }
+
+  free (text);
+  if ((text = (char *) mymalloc (length)) == NULL)
+    return NULL;
+
+  offset = po->mail_header_offset;
+  memcpy (&stamp, BLOCK (offset) + HEAD_DATE, LONGSIZE);
+  date = (time_t) stamp;
+  sprintf (text, "Mail from %s, posted %s\n", po->from, ctime (&date));
+  strncat (text, BLOCK (offset) + HEAD_MSG, HEADBLOCKSIZE);
+  while ((offset = next_of (offset)) != 0)
+    strncat (text, BLOCK (offset) + DATA_MSG, DATABLOCKSIZE);
+
   remove_offset (pi, po);
   /* Note : Initially I made the mail removal routines with the idea that
      it all would look a more like e.g the standard unix mailsystem
@@ -328,312 +383,254 @@ char recipient[NAMESIZE];
      now (hence the way a call to remove_offset looks) but maybe we'd
      like to change the system later on so I'll keep it this way.
    */
-  fclose (mailfp);
   return text;
 }
 
 
-#ifdef MAX_MAIL_AGE
-
-int delete_old (base)
-struct free_list_struct *base;
-{
-
-  struct free_list_struct *p = base;
-  unsigned int blocks = 0;
-
-  while (p->next != NULL) {
-    base = p;
-    p = p->next;
-    free (base);
-    blocks += add_free_list (p->zero_offset);
-  }
-  return blocks;
-}
-
-#endif
-
-
-
 /* SCAN_FILE */
 /* Call this function once, at game reboot, to setup the memory index lists
-  etc for the mailsystem. If you know what you're doing you may call it again
-  while the system is up to use another mailfile or something or maybe check
-  the current mailfile for errors but then you'd have to free all the linked
-  list elements of 'free_list' and 'mail_index' first.
+  etc for the mailsystem.  The mailfile is created if there is none, and
+  file is the one used from then on.
   Scan_file currently also deletes old mails if MAX_MAIL_AGE has been
-  defined. If you don't want old mails deleted, just undefine MAX_MAIL_AGE
-  in maildef.h.
+  defined, and data blocks no mail leads to.  If you don't want old mails
+  deleted, just undefine MAX_MAIL_AGE in maildef.h.
   If scan_file returns NULL, disable the mailsystem. */
 
 int scan_file (file)
 char *file;
 {
-
-  extern FILE *mailfp;
-  char byte;
-  struct head_block *tmp_hbl;
+  char to[NAMESIZE], from[NAMESIZE];
+  long offset, next, date, curtime, size, no_of_mails = 0;
+  unsigned int used_blocks = 0, free_blocks = 0, lost_blocks = 0;
 #ifdef MAX_MAIL_AGE
-  unsigned int blocks_deleted = 0;
-  unsigned int mails_deleted = 0;
-  struct free_list_struct *delete_offsets;
-
+  unsigned int blocks_deleted = 0, mails_deleted = 0;
 #endif
-  extern struct free_list_struct *free_list;
-  extern struct mail_index_struct *mail_index;
-  extern long end_of_file;
-  unsigned int free_blocks = 0;
-  unsigned int used_blocks = 0;
+  struct stat st;
 
-  long fpos, curtime, no_of_mails = 0;
+  mailfile = file;
+  curtime = (long) time (0);
 
-  end_of_file = 0L;
-  time (&curtime);
-  tmp_hbl = (struct head_block *) mymalloc (sizeof (struct head_block));
-
-  /* Allocate memory for 1:st element in linked list over free
-     blocks in the mailfile. */
-  if ((free_list = (struct free_list_struct *) mymalloc (FREESIZE)) == NULL)
-    return NULL;
-  free_list->next = NULL;
-
-  /* Allocate memory for 1:st element in the mail_index list where each
-     element points to a list with mails for a single person.
-     (The latter list is really a list of file offsets for all the
-     mails to a specific player) */
-  if ((mail_index =
-      (struct mail_index_struct *) mymalloc (INDEXSIZE)) == NULL)
-    return NULL;
-  mail_index->next = NULL;
-
-#ifdef MAX_MAIL_AGE
-  delete_offsets = (struct free_list_struct *) mymalloc (FREESIZE);
-  delete_offsets->next = NULL;
+  /* Open the mailfile and map it */
+#ifdef WIN32
+  if ((mailfp = fopen (file, "rb+")) == NULL &&
+    (mailfp = fopen (file, "wb+")) == NULL) {
+    fprintf (stderr, "Can't open mailfile %s.\n", file);
+    return 0;
+  }
+  fstat (fileno (mailfp), &st);
+#else
+  if ((mailfd = open (file, O_RDWR | O_CREAT, 0644)) < 0) {
+    fprintf (stderr, "Can't open mailfile %s.\n", file);
+    return 0;
+  }
+  fstat (mailfd, &st);
+#endif
+  size = st.st_size - st.st_size % BLOCKSIZE;
+  if (!resize_map (size > 128 * BLOCKSIZE ? size : 128 * BLOCKSIZE))
+    return 0;
+#ifdef WIN32
+  fread (mail_map, size, 1, mailfp);
 #endif
 
-  /* Open the mailfile for scanning */
-  if ((mailfp = fopen (file, "rb+")) == NULL) {
-    fprintf (stderr, "Can't open mailfile. Creating a new one.\n");
-    return 1;
-  }
+  /* Unused room left at the end by an earlier run isn't part of it */
+  for (end_of_file = size; end_of_file > 0 &&
+    *BLOCK (end_of_file - BLOCKSIZE) == MAIL_FREE;
+    end_of_file -= BLOCKSIZE);
 
-  /* Read the first block of the mailfile - this block is supposed
-     to be marked as either empty or a header block. */
-  fread (tmp_hbl, BLOCKSIZE, 1, mailfp);
-  if (tmp_hbl->the_mean_byte != 1 && tmp_hbl->the_mean_byte != 0) {
-    fprintf (stderr, "1:st block not a header block byt type %d\n",
-      tmp_hbl->the_mean_byte);
-    fprintf (stderr, "Mailfile corrupt.\n");
-    /* 'One drop of poison infects the whole tun of wine' */
-    return NULL;
+  for (offset = 0; offset < end_of_file; offset += BLOCKSIZE) {
+    if (*BLOCK (offset) == MAIL_FREE) {
+      SET_FREE (BLOCKNR (offset));
+      free_blocks++;
+    } else if (*BLOCK (offset) != MAIL_HEAD && *BLOCK (offset) != MAIL_DATA) {
+      fprintf (stderr, "Wrong mean_byte error, char was '%c'[%d]\n",
+        *BLOCK (offset), *BLOCK (offset));
+      fprintf (stderr, "FPOS %ld\n", offset);
+      fprintf (stderr, "Mailfile corrupt.\n");
+      /* 'One drop of poison infects the whole tun of wine' */
+      return 0;
+    }
   }
+  first_free = 0;
+
+  for (offset = 0; offset < end_of_file; offset += BLOCKSIZE) {
+    if (*BLOCK (offset) != MAIL_HEAD)
+      continue;
 
-  /* Copy to, from & offset to curr_offset and mail_index element */
-  if (tmp_hbl->the_mean_byte == 1) {
     used_blocks++;
     no_of_mails++;
+    for (next = offset; next_of (next) > 0 && next_of (next) < end_of_file &&
+      *BLOCK (next_of (next)) == MAIL_DATA &&
+      prev_block[BLOCKNR (next_of (next))] < 0; next = next_of (next)) {
+      prev_block[BLOCKNR (next_of (next))] = next;
+      used_blocks++;
+    }
+    if (next_of (next) != 0) {
+      set_next (next, 0L);
+      sync_block (next);
+    }
+
+    memcpy (&date, BLOCK (offset) + HEAD_DATE, LONGSIZE);
 #ifdef MAX_MAIL_AGE
-    if (curtime - tmp_hbl->date > MAX_MAIL_AGE) {
-      add_free (0L, delete_offsets);
+    /* If it is old - delete it */
+    if (curtime - date > MAX_MAIL_AGE) {
+      blocks_deleted += add_free_list (offset);
       mails_deleted++;
-    } else
+      continue;
+    }
 #endif
-      add_mail (tmp_hbl->to, tmp_hbl->from, 0L);
-  } else {
-    add_free (0L, free_list);
-    free_blocks++;
+    /*********** MAYBE REMOVE THESE LINES ************/
+    memcpy (to, BLOCK (offset) + HEAD_TO, NAMESIZE);
+    memcpy (from, BLOCK (offset) + HEAD_FROM, NAMESIZE);
+    to[NAMESIZE - 1] = 0;
+    from[NAMESIZE - 1] = 0;
+    /* Maybe better to set NAMESIZE to the actual namesize + 1 */
+    /*********** MAYBE REMOVE THESE LINES ************/
+
+    /* Add mail to the amazing lists! */
+    add_mail (to, from, offset);
   }
 
-  while (1) {
-    /* Read a byte and check if we got one - if not, we're at
-       the E of the F */
-    if (fread (&byte, sizeof (char), 1, mailfp) != 1) {
-      end_of_file = ftell (mailfp);
-      break;
+  /* Data blocks that no mail leads to */
+  for (offset = BLOCKSIZE; offset < end_of_file; offset += BLOCKSIZE)
+    if (*BLOCK (offset) == MAIL_DATA && prev_block[BLOCKNR (offset)] < 0) {
+      free_block (offset);
+      lost_blocks++;
     }
-    if (byte == 2) {            /* Data block */
-      used_blocks++;
-      fseek (mailfp, BLOCKSIZE - CHARSIZE, SEEK_CUR);
-    } else if (byte == 0) {
-      /* Allocate new free_list element and
-         save file offset (#bytes from the beginning). */
-      free_blocks++;
-      add_free (ftell (mailfp) - CHARSIZE, free_list);
-      fseek (mailfp, BLOCKSIZE - CHARSIZE, SEEK_CUR);
-    } else if (byte == 1) {     /* Header block */
-      /* Read it before it's too late! (Well..) */
-      fread ((void *) ((int) tmp_hbl + 1), BLOCKSIZE - 1, 1, mailfp);
-
-      /*********** MAYBE REMOVE THESE LINES ************/
-      tmp_hbl->to[NAMESIZE - 1] = 0;
-      tmp_hbl->from[NAMESIZE - 1] = 0;
-      /* Maybe better to set NAMESIZE to the actual namesize + 1 */
-      /*********** MAYBE REMOVE THESE LINES ************/
-      no_of_mails++;
-      used_blocks++;
 
-#ifdef MAX_MAIL_AGE
-      /* If it is old - delete it */
-      if (curtime - tmp_hbl->date > MAX_MAIL_AGE) {
-        add_free (ftell (mailfp) - BLOCKSIZE, delete_offsets);
-        mails_deleted++;
-        continue;
-      }
-#endif
-      /* Add mail to the amazing lists! */
-      add_mail (tmp_hbl->to, tmp_hbl->from, ftell (mailfp) - BLOCKSIZE);
-    } else {
-      if (byte != EOF) {
-        fprintf (stderr, "Wrong mean_byte error, char was '%c'[%d]\n", byte,
-          byte);
-        fprintf (stderr, "FPOS %u\n", ftell (mailfp));
-        return NULL;
-      }
-    }
-  }
-#ifdef MAX_MAIL_AGE
-  blocks_deleted = delete_old (delete_offsets);
-#endif
   fprintf (stderr,
     "***************************** MAILSYS *****************************\n");
-  fprintf (stderr, "Mailfile read : %s, size was %u bytes, ",
-    MAILFILE, end_of_file);
-  fprintf (stderr, "blocksize %d\nTotal # of unread mails %u\n", BLOCKSIZE,
+  fprintf (stderr, "Mailfile read : %s, size was %ld bytes, ",
+    mailfile, end_of_file);
+  fprintf (stderr, "blocksize %d\nTotal # of unread mails %ld\n", BLOCKSIZE,
     no_of_mails);
 
   fprintf (stderr, "Used blocks : %u (%u bytes)\n",
     used_blocks, (used_blocks * BLOCKSIZE));
   fprintf (stderr, "Free blocks : %u (%u bytes)\n",
     free_blocks, (free_blocks * BLOCKSIZE));
+  if (lost_blocks)
+    fprintf (stderr, "Freed %u data blocks not in any mail\n", lost_blocks);
 #ifdef MAX_MAIL_AGE
   fprintf (stderr, "Of these, %u was deleted due to old age (%u blocks)\n\n",
     mails_deleted, blocks_deleted);
 #endif
-  fclose (mailfp);
   return 1;
 }
 
 
-
-void writeblock (buf, nextpos)
-char *buf;
-long nextpos;
-{
-  extern FILE *mailfp;
-
-  memcpy (buf + BLOCKSIZE - LONGSIZE, &nextpos, LONGSIZE);
-  if (fwrite (buf, BLOCKSIZE, 1, mailfp) != 1) {
-    fprintf (stderr, "Fwrite at fpos %u failed.\n", ftell (mailfp));
-    return;
-  }
-}
-
-
 /************************************************************
  * This is store_mail - the current version is so much more *
  * easy and convenient to follow than the previous one that *
  * was a real meanie and also had a few very weird bugs.    *
  ************************************************************/
-/* Maybe I should make this one check for errors a bit too. */
 
 void store_mail (to, from, buf)
 char *to, *from, *buf;
 {
-  FILE *mailfp;
-  extern long end_of_file;
-
-  char shovel[BLOCKSIZE];
-  char append = '\0';
-  long fpos, next_pos, buflen, curtime, buf_index = 0L;
-
-  printf ("Storemail.\n");
-  memset (shovel, '\0', BLOCKSIZE);
-  shovel[0] = 1;
-  printf ("1..\n");
-  time (&curtime);
-  memcpy (shovel + CHARSIZE, &curtime, LONGSIZE);
-  strncpy (shovel + BLOCKSIZE - DATABLOCKSIZE, to, NAMESIZE);
-  strncpy (shovel + BLOCKSIZE - DATABLOCKSIZE + NAMESIZE, from, NAMESIZE);
-  strncpy (shovel + BLOCKSIZE - (LONGSIZE + HEADBLOCKSIZE), buf,
-    HEADBLOCKSIZE);
-  printf ("2..\n");
-  if (end_of_file == 0) {       /* eof stts av scan_file */
-    if ((mailfp = fopen (MAILFILE, "wb+")) == NULL) {
-      fprintf (stderr, "Unable to open mailfile.\n");
-      return;
-    }
-    append = 1;
-    fpos = 0L;
-  } else {
-    if ((mailfp = fopen (MAILFILE, "rb+")) == NULL) {
-      fprintf (stderr, "Unable to open mailfile!\n");
-      return;
-    }
-    if ((fpos = get_free_offset ()) == 1) {
-      fpos = end_of_file;
-      append = 1;
-    }
-  }
+  long offset, next, curtime, buflen, buf_index;
 
-  printf ("3..\n");
-  buflen = strlen (buf);
-  fseek (mailfp, fpos, SEEK_SET);
-  printf ("4..\n");
-/*
-  add_mail(to, from, fpos);
-*/
-
-  printf ("5..\n");
-  if (buflen <= HEADBLOCKSIZE) {
-    writeblock (shovel, NULL);  /* If it's just a header block */
-    if (append)
-      end_of_file += BLOCKSIZE;
+  curtime = (long) time (0);
+  if ((offset = new_block (0)) < 0) {
+    fprintf (stderr, "Unable to store mail.\n");
     return;
   }
 
-  printf ("6..\n");
-  if (append) {
-    next_pos = fpos + BLOCKSIZE;
-    end_of_file = next_pos;
-  } else {
-    next_pos = get_free_offset ();      /* Get fpos for next headblock */
-    if (next_pos == 1) {
-      next_pos = end_of_file;
+  memset (BLOCK (offset), '\0', BLOCKSIZE);
+  *BLOCK (offset) = MAIL_HEAD;
+  memcpy (BLOCK (offset) + HEAD_DATE, &curtime, LONGSIZE);
+  strncpy (BLOCK (offset) + HEAD_TO, to, NAMESIZE);
+  strncpy (BLOCK (offset) + HEAD_FROM, from, NAMESIZE);
+  strncpy (BLOCK (offset) + HEAD_MSG, buf, HEADBLOCKSIZE);
+  add_mail (to, from, offset);
+
+  buflen = strlen (buf);
+  for (buf_index = HEADBLOCKSIZE; buf_index < buflen;
+    buf_index += DATABLOCKSIZE) {
+    /* new_block() may move the map, so nothing is kept as a pointer */
+    if ((next = new_block (1)) < 0) {
+      fprintf (stderr, "Unable to store all of mail.\n");
+      break;
     }
+    set_next (offset, next);
+    sync_block (offset);
+    prev_block[BLOCKNR (next)] = offset;
+
+    offset = next;
+    memset (BLOCK (offset), '\0', BLOCKSIZE);
+    *BLOCK (offset) = MAIL_DATA;
+    strncpy (BLOCK (offset) + DATA_MSG, buf + buf_index, DATABLOCKSIZE);
   }
+  set_next (offset, 0L);
+  sync_block (offset);
+}
 
-  printf ("7..\n");
-  writeblock (shovel, next_pos);
-  buf_index = HEADBLOCKSIZE;
 
-  shovel[0] = 2;
-  printf ("8..\n");
-  while (buf_index < buflen) {
-    if (next_pos == end_of_file) {
-      end_of_file += BLOCKSIZE;
-      append = 1;
-    }
-    fpos = next_pos;
-    fseek (mailfp, fpos, SEEK_SET);
-    strncpy (shovel + CHARSIZE, buf + buf_index, DATABLOCKSIZE);
-    buf_index += DATABLOCKSIZE;
-    if (buf_index < buflen) {
-      if (!append) {
-        next_pos = get_free_offset ();
-        if (next_pos == 1) {
-          next_pos = end_of_file;
-        }
-      } else
-        next_pos = end_of_file;
-    } else
-      next_pos = NULL;
-    writeblock (shovel, next_pos);
+/* Move the block at from to the free block at to, and point whatever
+  pointed at it to its new place */
+static void move_block (from, to)
+long from, to;
+{
+  struct mail_index_struct *mi;
+  struct mail_offset_struct *mo;
+  char name[NAMESIZE];
+  long next;
+
+  memcpy (BLOCK (to), BLOCK (from), BLOCKSIZE);
+  SET_USED (BLOCKNR (to));
+  sync_block (to);
+
+  if (*BLOCK (to) == MAIL_HEAD) {
+    memcpy (name, BLOCK (to) + HEAD_TO, NAMESIZE);
+    name[NAMESIZE - 1] = 0;
+    if ((mi = get_index_pos (name)) != NULL)
+      for (mo = mi->my_first_mail; mo != NULL; mo = mo->my_next_mail)
+        if (mo->mail_header_offset == from)
+          mo->mail_header_offset = to;
+  } else {
+    set_next (prev_block[BLOCKNR (from)], to);
+    sync_block (prev_block[BLOCKNR (from)]);
+    prev_block[BLOCKNR (to)] = prev_block[BLOCKNR (from)];
   }
-  printf ("9.\n");
-  fclose (mailfp);
+  if ((next = next_of (to)) != 0)
+    prev_block[BLOCKNR (next)] = to;
+
+  free_block (from);
 }
 
 
+/* MAIL_COMPACT */
+/* Call this now and then, say once a pulse, to keep the mailfile short.
+  It moves at most blocks blocks from the end of the file into free ones
+  nearer the start, and gives back the room at the end once it's done.
+  Returns the number of blocks moved, 0 when there is nothing to do. */
+
+int mail_compact (blocks)
+int blocks;
+{
+  long hole, last;
+  int moved = 0;
+
+  while (moved < blocks) {
+    for (; end_of_file > 0 && IS_FREE (BLOCKNR (end_of_file - BLOCKSIZE));
+      end_of_file -= BLOCKSIZE)
+      SET_USED (BLOCKNR (end_of_file - BLOCKSIZE));
+
+    last = end_of_file - BLOCKSIZE;
+    if (last <= 0 || (hole = find_free (*BLOCK (last) == MAIL_DATA)) < 0)
+      break;
+
+    move_block (last, hole * BLOCKSIZE);
+    moved++;
+  }
+
+#ifndef WIN32
+  if (!moved && mail_size > 2 * end_of_file && mail_size > 256 * BLOCKSIZE)
+    resize_map (end_of_file > 128 * BLOCKSIZE ? end_of_file :
+      128 * BLOCKSIZE);
+#endif
+  return moved;
+}
+
 
 /***********************************************************************
  * On popular demand I sacrificed a lot of sweat and tears making this *
@@ -25,35 +25,37 @@
 #define HEADBLOCKSIZE (BLOCKSIZE-((LONGSIZE*2)+CHARSIZE+(NAMESIZE*2)))
 #define DATABLOCKSIZE (BLOCKSIZE-(LONGSIZE+CHARSIZE))
 #define OFFSETSIZE sizeof(struct mail_offset_struct)
-#define FREESIZE sizeof(struct free_list_struct)
 #define INDEXSIZE sizeof(struct mail_index_struct)
 
-/* MAX_MAIL_AGE == 2 months (5184000 seconds) */
-
-#define MAX_MAIL_AGE 5184000
-#define MAILFILE "/usr/users/groo/mailsys/hej.x"
+/* Where things are in a block.  Every block starts with its type (the mean
+  byte) and ends with the offset of the next block of the mail, 0 if it is
+  the last.  A header block has the date and the names in between, and
+  HEADBLOCKSIZE bytes of the text; a data block just DATABLOCKSIZE bytes of
+  text.  Offset 0 is only ever a header block, so 0 is never a next. */
 
+#define MAIL_FREE 0
+#define MAIL_HEAD 1
+#define MAIL_DATA 2
 
-struct head_block {
-  char the_mean_byte;
-  long date;
-  char to[NAMESIZE], from[NAMESIZE];
-  char msg[HEADBLOCKSIZE];
-  long offset;
-};
+#define HEAD_DATE CHARSIZE
+#define HEAD_TO (HEAD_DATE+LONGSIZE)
+#define HEAD_FROM (HEAD_TO+NAMESIZE)
+#define HEAD_MSG (HEAD_FROM+NAMESIZE)
+#define DATA_MSG CHARSIZE
+#define BLOCK_NEXT (BLOCKSIZE-LONGSIZE)
 
+/* MAX_MAIL_AGE == 2 months (5184000 seconds) */
 
-struct dblock {
-  char the_mean_byte;
-  char msg[DATABLOCKSIZE];
-  long offset;
-};
+#define MAX_MAIL_AGE 5184000
 
+/* The mailfile, relative to the lib directory like the other data files.
+  scan_file() is given the name to use; this is only the usual one. */
+#ifndef MAILFILE
+#define MAILFILE "mailfile"
+#endif
 
-struct free_list_struct {
-  long zero_offset;
-  struct free_list_struct *next;
-};
+/* Number of lists in the index of recipients */
+#define MAIL_HASH_SIZE 256
 
 
 struct mail_offset_struct {
@@ -16,15 +16,58 @@
 extern struct char_data *character_list;
 extern struct index_data *mob_index;
 extern struct room_data *world;
+extern struct zone_data *zone_table;
+extern int top_of_zone_table;
+extern struct descriptor_data *descriptor_list;
 extern struct str_app_type str_app[];
 
 void hit (struct char_data *ch, struct char_data *victim, int type);
 
 
-void mobile_activity (void)
+static int mobile_pulse = 0;
+static int *awake_zone = 0;     /* the zones woken this pulse */
+static int num_awake;
+
+struct char_data *zone_next_mob = 0;    /* Next dude global trick */
+
+/* A zone is awake while a player stands in it or next door to it.
+   Everything else is dormant and only gets a pass every
+   ZONE_DORMANT_RATE mobile pulses, staggered by zone number so that
+   the idle world does not all run in the same pulse.  Each zone keeps
+   its mobiles in a list of its own, so only the zones that get a pass
+   are looked at. */
+static void wake_zone (int zone)
+{
+  if (zone_table[zone].awake != mobile_pulse) {
+    zone_table[zone].awake = mobile_pulse;
+    awake_zone[num_awake++] = zone;
+  }
+}
+
+
+static void wake_zones (void)
+{
+  struct descriptor_data *d;
+  struct zone_data *zone;
+  int i;
+
+  if (!awake_zone)
+    CREATE (awake_zone, int, top_of_zone_table + 1);
+  num_awake = 0;
+
+  for (d = descriptor_list; d; d = d->next)
+    if (!d->connected && d->character->in_room != NOWHERE) {
+      wake_zone (world[d->character->in_room].zone);
+      zone = &zone_table[world[d->character->in_room].zone];
+      for (i = 0; i < zone->num_neighbours; i++)
+        wake_zone (zone->neighbour[i]);
+    }
+}
+
+
+static void mobile_act (struct char_data *ch)
 {
   char buf[256];
-  register struct char_data *ch;
   struct char_data *tmp_ch;
   struct obj_data *obj, *best_obj, *worst_obj;
   int door, found, max, min;
@@ -34,77 +77,116 @@ void mobile_activity (void)
   void do_move (struct char_data *ch, char *argument, int cmd);
   void do_get (struct char_data *ch, char *argument, int cmd);
 
-  for (ch = character_list; ch; ch = ch->next)
-    if (IS_MOB (ch)) {
-      /* Examine call for special procedure */
-      if (IS_SET (ch->specials.act, ACT_SPEC) && !no_specials) {
-        if (!mob_index[ch->nr].func) {
-          sprintf (buf, "Non-Existing MOB[%d] SPEC procedure (mobact.c)",
-            mob_index[ch->nr].virtual);
-          log (buf);
-          REMOVE_BIT (ch->specials.act, ACT_SPEC);
-        } else {
-          if ((*mob_index[ch->nr].func) (ch, 0, ""))
-            continue;
-        }
-      }
+  /* Examine call for special procedure */
+  if (IS_SET (ch->specials.act, ACT_SPEC) && !no_specials) {
+    if (!mob_index[ch->nr].func) {
+      sprintf (buf, "Non-Existing MOB[%d] SPEC procedure (mobact.c)",
+        mob_index[ch->nr].virtual);
+      log (buf);
+      REMOVE_BIT (ch->specials.act, ACT_SPEC);
+    } else {
+      if ((*mob_index[ch->nr].func) (ch, 0, ""))
+        return;
+    }
+  }
+
+  if (AWAKE (ch) && !(ch->specials.fighting)) {
 
-      if (AWAKE (ch) && !(ch->specials.fighting)) {
-
-        if (IS_SET (ch->specials.act, ACT_SCAVENGER)) {
-          if (world[ch->in_room].contents && !number (0, 10)) {
-            for (max = 1, best_obj = 0, obj = world[ch->in_room].contents;
-              obj; obj = obj->next_content) {
-              if (CAN_GET_OBJ (ch, obj)) {
-                if (obj->obj_flags.cost > max) {
-                  best_obj = obj;
-                  max = obj->obj_flags.cost;
-                }
-              }
-            }                   /* for */
-
-            if (best_obj) {
-              obj_from_room (best_obj);
-              obj_to_char (best_obj, ch);
-              act ("$n gets $p.", FALSE, ch, best_obj, 0, TO_ROOM);
+    if (IS_SET (ch->specials.act, ACT_SCAVENGER)) {
+      if (world[ch->in_room].contents && !rng_number (RNG_AI, 0, 10)) {
+        for (max = 1, best_obj = 0, obj = world[ch->in_room].contents;
+          obj; obj = obj->next_content) {
+          if (CAN_GET_OBJ (ch, obj)) {
+            if (obj->obj_flags.cost > max) {
+              best_obj = obj;
+              max = obj->obj_flags.cost;
             }
           }
+        }                   /* for */
+
+        if (best_obj) {
+          obj_from_room (best_obj);
+          obj_to_char (best_obj, ch);
+          act ("$n gets $p.", FALSE, ch, best_obj, 0, TO_ROOM);
         }
-        /* Scavenger */
-        if (!IS_SET (ch->specials.act, ACT_SENTINEL) &&
-          (GET_POS (ch) == POSITION_STANDING) &&
-          ((door = number (0, 45)) <= 5) && CAN_GO (ch, door) &&
-          !IS_SET (world[EXIT (ch, door)->to_room].room_flags, NO_MOB) &&
-          !IS_SET (world[EXIT (ch, door)->to_room].room_flags, DEATH)) {
-          if (ch->specials.last_direction == door) {
-            ch->specials.last_direction = -1;
-          } else {
-            if (!IS_SET (ch->specials.act, ACT_STAY_ZONE)) {
-              ch->specials.last_direction = door;
-              do_move (ch, "", ++door);
-            } else {
-              if (world[EXIT (ch,
-                    door)->to_room].zone == world[ch->in_room].zone) {
-                ch->specials.last_direction = door;
-                do_move (ch, "", ++door);
-              }
-            }
+      }
+    }
+    /* Scavenger */
+    if (!IS_SET (ch->specials.act, ACT_SENTINEL) &&
+      (GET_POS (ch) == POSITION_STANDING) &&
+      ((door = rng_number (RNG_AI, 0, 45)) <= 5) && CAN_GO (ch, door) &&
+      !IS_SET (world[EXIT (ch, door)->to_room].room_flags, NO_MOB) &&
+      !IS_SET (world[EXIT (ch, door)->to_room].room_flags, DEATH)) {
+      if (ch->specials.last_direction == door) {
+        ch->specials.last_direction = -1;
+      } else {
+        if (!IS_SET (ch->specials.act, ACT_STAY_ZONE)) {
+          ch->specials.last_direction = door;
+          do_move (ch, "", ++door);
+        } else {
+          if (world[EXIT (ch,
+                door)->to_room].zone == world[ch->in_room].zone) {
+            ch->specials.last_direction = door;
+            do_move (ch, "", ++door);
           }
         }
+      }
+    }
 
-        /* if can go */
-        if (IS_SET (ch->specials.act, ACT_AGGRESSIVE)) {
-          found = FALSE;
-          for (tmp_ch = world[ch->in_room].people; tmp_ch && !found;
-            tmp_ch = tmp_ch->next_in_room) {
-            if (!IS_NPC (tmp_ch) && CAN_SEE (ch, tmp_ch)) {
-              if (!IS_SET (ch->specials.act, ACT_WIMPY) || !AWAKE (tmp_ch)) {
-                hit (ch, tmp_ch, 0);
-                found = TRUE;
-              }
-            }
+    /* if can go */
+    if (IS_SET (ch->specials.act, ACT_AGGRESSIVE)) {
+      found = FALSE;
+      for (tmp_ch = world[ch->in_room].people; tmp_ch && !found;
+        tmp_ch = tmp_ch->next_in_room) {
+        if (!IS_NPC (tmp_ch) && CAN_SEE (ch, tmp_ch)) {
+          if (!IS_SET (ch->specials.act, ACT_WIMPY) || !AWAKE (tmp_ch)) {
+            hit (ch, tmp_ch, 0);
+            found = TRUE;
           }
         }
-      }                         /* If AWAKE(ch)   */
-    }                           /* If IS_MOB(ch)  */
+      }
+    }
+  }                             /* If AWAKE(ch)   */
+}
+
+
+/* Every mobile in zone that has not yet had its turn this pulse; one
+   that walks into a zone still to come does not get a second. */
+static void zone_activity (int zone)
+{
+  struct char_data *ch;
+
+  for (ch = zone_table[zone].mobs; ch; ch = zone_next_mob) {
+    zone_next_mob = ch->next_in_zone;
+    if (IS_MOB (ch) && ch->acted != mobile_pulse) {
+      ch->acted = mobile_pulse;
+      mobile_act (ch);
+    }
+  }
+}
+
+
+void mobile_activity (void)
+{
+  struct char_data *ch;
+  int zone, i;
+
+  mobile_pulse++;
+
+  if (top_of_zone_table < 0) {
+    for (ch = character_list; ch; ch = ch->next)
+      if (IS_MOB (ch))
+        mobile_act (ch);
+    return;
+  }
+
+  wake_zones ();
+  for (i = 0; i < num_awake; i++)
+    zone_activity (awake_zone[i]);
+
+  /* the dormant zones whose turn it is */
+  for (zone = (ZONE_DORMANT_RATE - mobile_pulse % ZONE_DORMANT_RATE) %
+    ZONE_DORMANT_RATE; zone <= top_of_zone_table; zone += ZONE_DORMANT_RATE)
+    if (zone_table[zone].awake != mobile_pulse)
+      zone_activity (zone);
 }
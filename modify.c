@@ -23,6 +23,7 @@
 
 
 void show_string (struct descriptor_data *d, char *input);
+void pager_release (struct descriptor_data *d);
 
 
 
@@ -99,8 +100,16 @@ void string_add (struct descriptor_data *d, char *str)
     }
   }
 
+  /* a name being typed in may be realloc()ed in place */
+  if (d->str_keywords)
+    keywords_free (d->str_keywords);
+
   if (terminator) {
+    if (d->str_done)
+      (*d->str_done) (d->str);
     d->str = 0;
+    d->str_keywords = 0;
+    d->str_done = 0;
     if (d->connected == CON_EXDSCR) {
       SEND_TO_Q (MENU, d);
       d->connected = CON_SLCT;
@@ -160,6 +169,7 @@ void do_string (struct char_data *ch, char *arg, int cmd)
     return;
 
   quad_arg (arg, &type, name, &field, string);
+  ch->desc->str_keywords = 0;
 
   if (type == TP_ERROR) {
     send_to_char
@@ -186,6 +196,7 @@ void do_string (struct char_data *ch, char *arg, int cmd)
         return;
       }
       ch->desc->str = &GET_NAME (mob);
+      ch->desc->str_keywords = &mob->keywords;
       if (!IS_NPC (mob))
         send_to_char ("WARNING: You have changed the name of a player.\n\r",
           ch);
@@ -230,6 +241,7 @@ void do_string (struct char_data *ch, char *arg, int cmd)
     switch (field) {
     case 1:
       ch->desc->str = &obj->name;
+      ch->desc->str_keywords = &obj->keywords;
       break;
     case 2:
       ch->desc->str = &obj->short_description;
@@ -302,6 +314,8 @@ void do_string (struct char_data *ch, char *arg, int cmd)
   if (*ch->desc->str) {
     free (*ch->desc->str);
   }
+  if (ch->desc->str_keywords)
+    keywords_free (ch->desc->str_keywords);
 
   if (*string) {                /* there was a string in the argument array */
     if ((int)strlen (string) > length[field - 1]) {
@@ -311,6 +325,7 @@ void do_string (struct char_data *ch, char *arg, int cmd)
     CREATE (*ch->desc->str, char, strlen (string) + 1);
     strcpy (*ch->desc->str, string);
     ch->desc->str = 0;
+    ch->desc->str_keywords = 0;
     send_to_char ("Ok.\n\r", ch);
   } else {                      /* there was no string. enter string mode */
 
@@ -376,20 +391,81 @@ char *one_word (char *argument, char *first_arg)
 }
 
 
-struct help_index_element *build_help_index (FILE * fl, int *num)
+/* The help file is held in memory -- mapped where the system allows it
+   -- and found through a trie over every keyword, so do_help() can hand
+   the pager a slice of the file instead of reading and copying it. */
+
+struct help_node {
+  char letter;
+  int entry;                    /* first keyword with this prefix */
+  int child;                    /* first node one letter on, -1 if none */
+  int sibling;                  /* next node under the same parent */
+};
+
+static char *help_text = 0;     /* the whole help file */
+static long help_size = 0;
+static struct help_node *help_trie = 0;
+static int help_trie_top = 0;
+
+
+static int help_node_add (char letter, int entry)
+{
+  static int size = 0;
+
+  if (help_trie_top >= size) {
+    size = size ? 2 * size : 1024;
+    if (help_trie)
+      RECREATE (help_trie, struct help_node, size);
+    else
+      CREATE (help_trie, struct help_node, size);
+  }
+
+  help_trie[help_trie_top].letter = letter;
+  help_trie[help_trie_top].entry = entry;
+  help_trie[help_trie_top].child = -1;
+  help_trie[help_trie_top].sibling = -1;
+
+  return (help_trie_top++);
+}
+
+
+static int help_compare (const void *a, const void *b)
+{
+  return (str_cmp (((struct help_index_element *) a)->keyword,
+      ((struct help_index_element *) b)->keyword));
+}
+
+
+/* index every keyword of every entry in the help text; each keyword
+   points at the whole entry, header line included */
+struct help_index_element *build_help_index (char *text, long size, int *num)
 {
-  int nr = -1, issorted, i;
-  struct help_index_element *list = 0, mem;
-  char buf[81], tmp[81], *scan;
-  long pos;
-
-  for (;;) {
-    pos = ftell (fl);
-    FGETS (buf, 81, fl);
-    *(buf + strlen (buf) - 1) = '\0';
-    scan = buf;
+  int nr = -1, i, node, next;
+  struct help_index_element *list = 0;
+  char buf[81], tmp[81], *scan, *point, *end, *entry, *eol;
+
+  end = text + size;
+
+  for (point = text; point < end;) {
+    entry = point;
+
+    /* the keywords */
+    for (i = 0; point < end && *point != '\n' && i < 80; point++)
+      buf[i++] = *point;
+    buf[i] = '\0';
+
+    /* skip the text */
     for (;;) {
-      /* extract the keywords */
+      if (!(eol = memchr (point, '\n', end - point))) {
+        point = end;
+        break;
+      }
+      point = eol + 1;
+      if (point >= end || *point == '#')
+        break;
+    }
+
+    for (scan = buf;;) {
       scan = one_word (scan, tmp);
 
       if (!*tmp)
@@ -401,90 +477,332 @@ struct help_index_element *build_help_index (FILE * fl, int *num)
       } else
         RECREATE (list, struct help_index_element, ++nr + 1);
 
-      list[nr].pos = pos;
       CREATE (list[nr].keyword, char, strlen (tmp) + 1);
       strcpy (list[nr].keyword, tmp);
+      list[nr].text = entry;
+      list[nr].length = point - entry;
     }
-    /* skip the text */
-    do
-      FGETS (buf, 81, fl);
-    while (*buf != '#');
-    if (*(buf + 1) == '~')
+
+    if (point >= end || *(point + 1) == '~')
       break;
+
+    /* past the '#' line */
+    if ((eol = memchr (point, '\n', end - point)))
+      point = eol + 1;
+    else
+      point = end;
   }
-  /* we might as well sort the stuff */
-  do {
-    issorted = 1;
-    for (i = 0; i < nr; i++)
-      if (str_cmp (list[i].keyword, list[i + 1].keyword) > 0) {
-        mem = list[i];
-        list[i] = list[i + 1];
-        list[i + 1] = mem;
-        issorted = 0;
+
+  if (list)
+    qsort (list, nr + 1, sizeof (struct help_index_element), help_compare);
+
+  /* keywords go in sorted, so whoever makes a node first is the
+     alphabetically first keyword with that prefix */
+  help_trie_top = 0;
+  help_node_add ('\0', -1);     /* root */
+
+  for (i = 0; i <= nr; i++)
+    for (node = 0, scan = list[i].keyword; *scan; scan++, node = next) {
+      for (next = help_trie[node].child; next != -1;
+        next = help_trie[next].sibling)
+        if (help_trie[next].letter == LOWER (*scan))
+          break;
+
+      if (next == -1) {
+        next = help_node_add (LOWER (*scan), i);
+        help_trie[next].sibling = help_trie[node].child;
+        help_trie[node].child = next;
       }
-  }
-  while (!issorted);
+    }
 
   *num = nr;
   return (list);
 }
 
 
+/* the help entry with a keyword starting with the given word, if any */
+struct help_index_element *find_help (char *keyword)
+{
+  extern struct help_index_element *help_index;
+  int node;
+
+  if (!help_index || !*keyword)
+    return (0);
+
+  for (node = 0; *keyword; keyword++) {
+    for (node = help_trie[node].child; node != -1;
+      node = help_trie[node].sibling)
+      if (help_trie[node].letter == LOWER (*keyword))
+        break;
+
+    if (node == -1)
+      return (0);
+  }
+
+  return (&help_index[help_trie[node].entry]);
+}
+
+
+static void unload_help (void)
+{
+  extern struct help_index_element *help_index;
+  extern int top_of_helpt;
+  extern struct descriptor_data *descriptor_list;
+  struct descriptor_data *d;
+  char *text;
+  int i;
+
+  /* anyone still reading an entry gets their own copy of it; the line
+     offsets are relative to the start, so they stay good */
+  for (d = descriptor_list; d; d = d->next)
+    if (d->pager && !d->pager->own &&
+      d->pager->text >= help_text && d->pager->text < help_text + help_size) {
+      i = d->pager->line[d->pager->num_lines];
+      CREATE (text, char, i + 1);
+      memcpy (text, d->pager->text, i);
+      d->pager->text = text;
+      d->pager->own = 1;
+    }
+
+  if (help_index) {
+    for (i = 0; i <= top_of_helpt; i++)
+      free (help_index[i].keyword);
+    free (help_index);
+    help_index = 0;
+  }
+
+  if (help_text) {
+#ifndef WIN32
+    munmap (help_text, help_size);
+#else
+    free (help_text);
+#endif
+    help_text = 0;
+  }
+}
+
+
+/* (re)read the help file and index it */
+void boot_help (void)
+{
+  extern struct help_index_element *help_index;
+  extern int top_of_helpt;
+#ifndef WIN32
+  int fd;
+  struct stat st;
+#else
+  FILE *fl;
+#endif
+
+  unload_help ();
+
+#ifndef WIN32
+  if ((fd = open (HELP_KWRD_FILE, O_RDONLY)) < 0) {
+    log ("   Could not open help file.");
+    return;
+  }
+  if (fstat (fd, &st) < 0 || st.st_size <= 0 ||
+    (help_text = (char *) mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd,
+        0)) == (char *) MAP_FAILED) {
+    log ("   Could not map help file.");
+    help_text = 0;
+    close (fd);
+    return;
+  }
+  close (fd);
+  help_size = st.st_size;
+#else
+  if (!(fl = fopen (HELP_KWRD_FILE, "rb"))) {
+    log ("   Could not open help file.");
+    return;
+  }
+  fseek (fl, 0, SEEK_END);
+  if ((help_size = ftell (fl)) <= 0) {
+    log ("   Could not read help file.");
+    fclose (fl);
+    return;
+  }
+  CREATE (help_text, char, help_size);
+  fseek (fl, 0, SEEK_SET);
+  help_size = fread (help_text, 1, help_size, fl);
+  fclose (fl);
+#endif
+
+  help_index = build_help_index (help_text, help_size, &top_of_helpt);
+}
+
+
+
+/* Start d paging through length bytes of text, which becomes the pager's
+   own if own is set.  Lines are found once, here; trailing blank lines
+   are dropped so that the last page is not empty. */
+static void pager_open (struct descriptor_data *d, char *text, int length,
+  int own)
+{
+  struct pager *pg;
+  char *scan, *end = text + length;
+  int lines;
+
+  if (d->pager)
+    pager_release (d);
+
+  for (lines = 1, scan = text; scan < end; scan++)
+    if (*scan == '\n')
+      lines++;
+
+  CREATE (pg, struct pager, 1);
+  CREATE (pg->line, int, lines + 1);
+  pg->text = text;
+  pg->own = own;
+
+  for (scan = text, lines = 0; scan < end;) {
+    pg->line[lines++] = scan - text;
+    while (scan < end && *scan != '\n')
+      scan++;
+    if (scan < end)
+      scan++;
+    if (scan < end && *scan == '\r')
+      scan++;
+  }
+  pg->line[lines] = length;
+
+  while (lines > 0) {
+    for (scan = text + pg->line[lines - 1]; scan < end && isspace ((int)*scan);
+      scan++);
+    if (scan < end)
+      break;
+    end = text + pg->line[--lines];
+  }
+  pg->line[lines] = end - text;
+  pg->num_lines = lines;
+  pg->page = -1;
+
+  d->pager = pg;
+}
+
+
+void pager_release (struct descriptor_data *d)
+{
+  if (!d->pager)
+    return;
+
+  if (d->pager->own)
+    free (d->pager->text);
+  free (d->pager->line);
+  free (d->pager);
+  d->pager = 0;
+}
+
+
+/* send one page; a bare newline goes out as "\n\r" */
+static void pager_show (struct descriptor_data *d, int page)
+{
+  char buffer[MAX_STRING_LENGTH];
+  struct pager *pg = d->pager;
+  char *scan, *point, *end;
+  int first, last;
+
+  first = page * PAGE_LINES;
+  last = MIN (first + PAGE_LINES, pg->num_lines);
+  pg->page = page;
+
+  point = pg->text + pg->line[first];
+  end = pg->text + pg->line[last];
+
+  /* a page longer than the buffer goes out in more than one piece */
+  for (scan = buffer; point < end && *point;) {
+    if (scan >= buffer + MAX_STRING_LENGTH - 3) {
+      *scan = '\0';
+      write_to_q_len (buffer, scan - buffer, &d->output);
+      scan = buffer;
+    }
+    if ((*(scan++) = *(point++)) != '\n')
+      continue;
+    if (point < end && *point == '\r')
+      point++;
+    *(scan++) = '\r';
+  }
+  *scan = '\0';
+  write_to_q_len (buffer, scan - buffer, &d->output);
+
+  /* a text that fits on one page needs no pager */
+  if (first == 0 && last >= pg->num_lines)
+    pager_release (d);
+}
+
 
 void page_string (struct descriptor_data *d, char *str, int keep_internal)
 {
+  char *text;
+  int length;
+
   if (!d)
     return;
 
+  length = strlen (str);
+
   if (keep_internal) {
-    CREATE (d->showstr_head, char, strlen (str) + 1);
-    strcpy (d->showstr_head, str);
-    d->showstr_point = d->showstr_head;
+    CREATE (text, char, length + 1);
+    strcpy (text, str);
   } else
-    d->showstr_point = str;
+    text = str;
+
+  pager_open (d, text, length, keep_internal);
+  show_string (d, "");
+}
 
+
+/* page through text that is not ours to copy or terminate, such as a
+   help entry; it must stay put while the descriptor is reading it */
+void page_slice (struct descriptor_data *d, char *str, int length)
+{
+  if (!d)
+    return;
+
+  pager_open (d, str, length, 0);
   show_string (d, "");
 }
 
 
 
+/* Answer the pager prompt: return for the next page, B for the one
+   before, R to see this one again, a number to go to that page.
+   Anything else, or return on the last page, leaves the pager. */
 void show_string (struct descriptor_data *d, char *input)
 {
-  char buffer[MAX_STRING_LENGTH], buf[MAX_INPUT_LENGTH];
-  register char *scan, *chk;
-  int lines = 0, toggle = 1;
+  char buf[MAX_INPUT_LENGTH];
+  int page, pages;
+
+  if (!d->pager)
+    return;
 
   one_argument (input, buf);
 
-  if (*buf) {
-    if (d->showstr_head) {
-      free (d->showstr_head);
-      d->showstr_head = 0;
-    }
-    d->showstr_point = 0;
+  page = d->pager->page;
+  pages = (d->pager->num_lines + PAGE_LINES - 1) / PAGE_LINES;
+
+  if (!pages) {
+    pager_release (d);
     return;
   }
 
-  /* show a chunk */
-  for (scan = buffer;; scan++, d->showstr_point++)
-    if ((((*scan = *d->showstr_point) == '\n') || (*scan == '\r')) &&
-      ((toggle = -toggle) < 0))
-      lines++;
-    else if (!*scan || (lines >= 22)) {
-      *scan = '\0';
-      SEND_TO_Q (buffer, d);
-
-      /* see if this is the end (or near the end) of the string */
-      for (chk = d->showstr_point; isspace ((int)*chk); chk++);
-      if (!*chk) {
-        if (d->showstr_head) {
-          free (d->showstr_head);
-          d->showstr_head = 0;
-        }
-        d->showstr_point = 0;
-      }
+  if (!*buf) {
+    if (++page >= pages) {
+      pager_release (d);
       return;
     }
+  } else if (is_abbrev (buf, "back"))
+    page--;
+  else if (is_abbrev (buf, "refresh"))
+    ;
+  else if (is_number (buf))
+    page = atoi (buf) - 1;
+  else {
+    pager_release (d);
+    return;
+  }
+
+  pager_show (d, MAX (0, MIN (page, pages - 1)));
 }
 
 
@@ -556,6 +874,7 @@ void check_reboot (void)
           restore_signals();
         }
 
+        copyover (0);           /* only returns if it could not be done */
         send_to_all ("Automatic reboot. Come back in a little while.\n\r");
 #ifdef __FreeBSD__
         shutdown_server = greboot = 1;
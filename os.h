@@ -76,6 +76,7 @@
 #define NOFILE FD_SETSIZE
 #include <winsock2.h>
 #include <process.h>
+#include <io.h>
 
 #if defined __LCC__ || defined _MSC_VER
 #include <direct.h>
@@ -149,6 +150,7 @@ extern int re_exec (char *);
 #define bcmp(s, d, n)   memcmp((d), (s), (n))
 #define bzero(s, n)      memset((s), 0, (n))
 #define getdtablesize() FD_SETSIZE
+#define fsync(fd) _commit(fd)
 #define OS_RAND rand
 #define OS_SRAND srand
 
@@ -203,6 +205,8 @@ extern char *fgets_win (char *buf, int n, FILE * fp);
 #include <sys/param.h>
 #include <sys/resource.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <pthread.h>
 #ifndef __FreeBSD__
 #include <crypt.h>
 #endif
@@ -36,6 +36,10 @@ extern void update_pos (struct char_data *victim);
 /* modify.c */
 extern void night_watchman (void);
 extern void page_string (struct descriptor_data *d, char *str, int keep_internal);
+extern void page_slice (struct descriptor_data *d, char *str, int length);
+extern void pager_release (struct descriptor_data *d);
+extern void boot_help (void);
+extern struct help_index_element *find_help (char *keyword);
 
 /* signals.c */
 void signal_setup (void);
@@ -57,7 +61,19 @@ extern int str_cmp (char *arg1, char *arg2);
 extern int strn_cmp (char *arg1, char *arg2, int n);
 extern int number (int from, int to);
 extern void log (char *str);
+extern void log_at (int system, int level, char *str);
+extern void log_open (char *file);
+extern void log_pulse (void);
+extern void log_flush (void);
+extern void log_child (void);
+extern void event_open (char *file);
+extern void event (int type, struct char_data *ch, int target, int value,
+  int extra);
+extern int event_id (struct char_data *ch);
 extern int dice (int number, int size);
+extern void rng_seed (unsigned long seed);
+extern int rng_number (int stream, int from, int to);
+extern int rng_dice (int stream, int number, int size);
 extern void sprinttype (int type, char *names[], char *result);
 extern void sprintbit (long vektor, char *names[], char *result);
 #if !defined MIN
@@ -15,8 +15,7 @@
 #include "spells.h"
 #include "prototypes.h"
 
-#define OBJ_SAVE_FILE "pcobjs.obj"
-#define OBJ_FILE_FREE "\0\0\0"
+#define OBJ_SAVE_FILE "pcobjs.obj"       /* read once, to move it to RENT_FILE */
 
 extern struct room_data *world;
 extern struct index_data *mob_index;
@@ -87,10 +86,10 @@ bool recep_offer (struct char_data *ch, struct char_data *receptionist,
     return (FALSE);
   }
 
-  if (cost->no_carried > MAX_OBJ_SAVE) {
+  if (cost->no_carried > MAX_RENT_OBJS) {
     sprintf (buf,
       "$n tells you 'Sorry, but I can't store any more than %d items.",
-      MAX_OBJ_SAVE);
+      MAX_RENT_OBJS);
     act (buf, FALSE, receptionist, 0, ch, TO_VICT);
     return (FALSE);
   }
@@ -118,31 +117,207 @@ bool recep_offer (struct char_data *ch, struct char_data *receptionist,
 
 
 /* ************************************************************************
-* General save/load routines                                              *
+* The rent file                                                           *
 ************************************************************************* */
 
-/* pos == 0 is first position in file! */
-void update_file (FILE * fl, int pos, struct obj_file_u *st)
+/* The rent file is kept open while the game runs.  Every record in use is
+   in rent_hash under its owner's name; unused ones are on rent_free by
+   size.  Records only come in sizes of RENT_MIN_OBJS << n objects, so a
+   freed record always fits the next renter of its class.                */
+
+#define RENT_HASH_SIZE 1024
+#define RENT_MIN_OBJS  8
+#define RENT_CLASSES   6        /* up to 256 objects, over MAX_RENT_OBJS */
+
+struct rent_index {
+  char owner[20];
+  long offset;                  /* of the record in the rent file */
+  int class;                    /* record has room for RENT_MIN_OBJS << class */
+  struct rent_index *next;
+};
+
+static FILE *rent_fl = 0;
+static long rent_end = 0;       /* where the next new record goes */
+static struct rent_index *rent_hash[RENT_HASH_SIZE];
+static struct rent_index *rent_free[RENT_CLASSES];
+
+
+#define RENT_SIZE(class) ((long) sizeof (struct rent_file_u) +          \
+  ((long) RENT_MIN_OBJS << (class)) * (long) sizeof (struct rent_obj_u))
+
+
+static int rent_hash_name (char *name)
 {
-  if (fseek (fl, sizeof (struct obj_file_u) * (pos), 0)) {
-    perror ("Seeking in file update (update_file, reception.c)");
+  unsigned long hash;
+
+  for (hash = 0; *name; name++)
+    hash = hash * 31 + LOWER (*name);
+
+  return (hash % RENT_HASH_SIZE);
+}
+
+
+static struct rent_index *rent_find (char *name)
+{
+  struct rent_index *ri;
+
+  for (ri = rent_hash[rent_hash_name (name)]; ri; ri = ri->next)
+    if (!str_cmp (ri->owner, name))
+      return (ri);
+
+  return (0);
+}
+
+
+static void rent_seek (long offset)
+{
+  journal_read (JOURNAL_RENT);
+  fflush (rent_fl);             /* drop what was read before the saves */
+  if (fseek (rent_fl, offset, 0)) {
+    perror ("Seeking in rent file");
     WIN32CLEANUP
     exit (1);
   }
-  if (fwrite (st, sizeof (struct obj_file_u), 1, fl) < 1) {
-    perror ("Error updating file (update_file, reception.c).");
-    WIN32CLEANUP
-    exit (1);
+}
+
+
+/* write through the journal, so the write survives a crash; it reaches
+   the file once the journal is synced */
+static void rent_write (long offset, void *data, long size)
+{
+  journal_write (JOURNAL_RENT, offset, data, (int) size);
+}
+
+
+/* the record for name, taken from rent_free or added at the end */
+static struct rent_index *rent_alloc (char *name, int num_objs)
+{
+  struct rent_index *ri;
+  int class;
+
+  for (class = 0; (RENT_MIN_OBJS << class) < num_objs; class++);
+
+  if ((ri = rent_free[class]))
+    rent_free[class] = ri->next;
+  else {
+    CREATE (ri, struct rent_index, 1);
+    ri->offset = rent_end;
+    ri->class = class;
+    rent_end += RENT_SIZE (class);
   }
 
-  /* WHY OH WHY?!??!? I can't tell, but I doesn't work without */
-  /* Something with update mode and reads after writes         */
-  if (fseek (fl, sizeof (struct obj_file_u) * (pos + 1), 0)) {
-    perror ("Seeking in file update (update_file, reception.c)");
-    WIN32CLEANUP
-    exit (1);
+  strcpy (ri->owner, name);
+  ri->next = rent_hash[rent_hash_name (name)];
+  rent_hash[rent_hash_name (name)] = ri;
+
+  return (ri);
+}
+
+
+/* mark a record unused, on disk and in memory */
+static void rent_release (struct rent_index *ri)
+{
+  struct rent_index **prev;
+  struct rent_file_u st;
+
+  for (prev = &rent_hash[rent_hash_name (ri->owner)]; *prev != ri;
+    prev = &(*prev)->next);
+  *prev = ri->next;
+
+  memset (&st, 0, sizeof (st));
+  st.max_objs = RENT_MIN_OBJS << ri->class;
+  rent_write (ri->offset, &st, sizeof (st));
+
+  *ri->owner = '\0';
+  ri->next = rent_free[ri->class];
+  rent_free[ri->class] = ri;
+}
+
+
+/* write a renter's record; the objects go first, so a record is only
+   found in use once all of it is there */
+static void rent_store (struct rent_file_u *st, struct rent_obj_u *objs)
+{
+  struct rent_index *ri;
+
+  if ((ri = rent_find (st->owner)))
+    rent_release (ri);
+
+  ri = rent_alloc (st->owner, st->num_objs);
+  st->max_objs = RENT_MIN_OBJS << ri->class;
+
+  rent_write (ri->offset + (long) sizeof (struct rent_file_u), objs,
+    (long) st->num_objs * sizeof (struct rent_obj_u));
+  if (!st->num_objs && ri->offset + RENT_SIZE (ri->class) == rent_end) {
+    /* make sure the file reaches the end of a new record */
+    rent_write (ri->offset + RENT_SIZE (ri->class) - 1, "", 1);
   }
 
+  rent_write (ri->offset, st, sizeof (struct rent_file_u));
+}
+
+
+/* forget the index, to build it again from the file */
+static void rent_clear (void)
+{
+  struct rent_index *ri;
+  int i;
+
+  for (i = 0; i < RENT_HASH_SIZE; i++)
+    for (; (ri = rent_hash[i]); free (ri))
+      rent_hash[i] = ri->next;
+
+  for (i = 0; i < RENT_CLASSES; i++)
+    for (; (ri = rent_free[i]); free (ri))
+      rent_free[i] = ri->next;
+
+  rent_end = 0;
+}
+
+
+/* copy the records of the old fixed-size object file into the rent file */
+static void rent_migrate (void)
+{
+  FILE *fl;
+  struct obj_file_u old;
+  struct rent_file_u st;
+  struct rent_obj_u objs[MAX_OBJ_SAVE];
+  char buf[MAX_STRING_LENGTH];
+  int i, count = 0;
+
+  if (!(fl = fopen (OBJ_SAVE_FILE, "rb")))
+    return;
+
+  /* records were appended, so line them up from the end of the file,
+     past any stray bytes at the start */
+  fseek (fl, 0L, 2);
+  fseek (fl, ftell (fl) % (long) sizeof (struct obj_file_u), 0);
+
+  while (fread (&old, sizeof (struct obj_file_u), 1, fl) == 1) {
+    if (!old.owner[0])
+      continue;
+
+    memset (&st, 0, sizeof (st));
+    memcpy (st.owner, old.owner, sizeof (st.owner) - 1);
+    st.gold_left = old.gold_left;
+    st.total_cost = old.total_cost;
+    st.last_update = old.last_update;
+
+    for (i = 0; i < MAX_OBJ_SAVE; i++)
+      if (old.objects[i].item_number > -1) {
+        objs[st.num_objs].obj = old.objects[i];
+        objs[st.num_objs++].in_obj = -1;
+      }
+
+    rent_store (&st, objs);
+    count++;
+  }
+
+  fclose (fl);
+
+  sprintf (buf, "   Moved %d renters from %s to %s.", count, OBJ_SAVE_FILE,
+    RENT_FILE);
+  log (buf);
 }
 
 
@@ -150,95 +325,124 @@ void update_file (FILE * fl, int pos, struct obj_file_u *st)
 * Routines used to load a characters equipment from disk                  *
 ************************************************************************* */
 
-void obj_store_to_char (struct char_data *ch, struct obj_file_u *st)
+void obj_store_to_char (struct char_data *ch, struct rent_file_u *st,
+  struct rent_obj_u *objs)
 {
-  struct obj_data *obj;
+  struct obj_data **obj;
+  struct obj_file_elem *elem;
   int i, j;
 
   void obj_to_char (struct obj_data *object, struct char_data *ch);
 
-  for (i = 0; i < MAX_OBJ_SAVE; i++) {
-    if (st->objects[i].item_number > -1) {
-      if (real_object (st->objects[i].item_number) > -1) {
-        obj = read_object (st->objects[i].item_number, VIRTUAL);
+  if (!st->num_objs)
+    return;
 
-        obj->obj_flags.value[0] = st->objects[i].value[0];
-        obj->obj_flags.value[1] = st->objects[i].value[1];
-        obj->obj_flags.value[2] = st->objects[i].value[2];
-        obj->obj_flags.value[3] = st->objects[i].value[3];
+  CREATE (obj, struct obj_data *, st->num_objs);
 
-        obj->obj_flags.extra_flags = st->objects[i].extra_flags;
-        obj->obj_flags.weight = st->objects[i].weight;
-        obj->obj_flags.timer = st->objects[i].timer;
-        obj->obj_flags.bitvector = st->objects[i].bitvector;
+  for (i = 0; i < st->num_objs; i++) {
+    elem = &objs[i].obj;
+    if (elem->item_number > -1 && real_object (elem->item_number) > -1) {
+      obj[i] = read_object (elem->item_number, VIRTUAL);
 
-        for (j = 0; j < MAX_OBJ_AFFECT; j++)
-          obj->affected[j] = st->objects[i].affected[j];
+      obj[i]->obj_flags.value[0] = elem->value[0];
+      obj[i]->obj_flags.value[1] = elem->value[1];
+      obj[i]->obj_flags.value[2] = elem->value[2];
+      obj[i]->obj_flags.value[3] = elem->value[3];
 
-        obj_to_char (obj, ch);
-      }
+      obj[i]->obj_flags.extra_flags = elem->extra_flags;
+      obj[i]->obj_flags.weight = elem->weight;
+      obj[i]->obj_flags.timer = elem->timer;
+      obj[i]->obj_flags.bitvector = elem->bitvector;
+
+      for (j = 0; j < MAX_OBJ_AFFECT; j++)
+        obj[i]->affected[j] = elem->affected[j];
     }
   }
+
+  /* containers come before what is in them; fill them, then hand over
+     whatever is left loose, so the weights add up as they go */
+  for (i = 0; i < st->num_objs; i++)
+    if (obj[i] && objs[i].in_obj >= 0 && objs[i].in_obj < i &&
+      obj[objs[i].in_obj]) {
+      obj_to_obj (obj[i], obj[objs[i].in_obj]);
+      obj[i] = 0;
+    }
+
+  for (i = st->num_objs - 1; i >= 0; i--)
+    if (obj[i])
+      obj_to_char (obj[i], ch);
+
+  free (obj);
 }
 
 
 void load_char_objs (struct char_data *ch)
 {
-  FILE *fl;
-  int pos, i, j;
-  bool found = FALSE;
+  struct rent_index *ri;
+  struct rent_file_u st;
+  struct rent_obj_u *objs = 0;
   float timegold;
-  struct obj_file_u st;
+  long days_passed;
+  char buf[MAX_STRING_LENGTH];
 
+  if (!(ri = rent_find (GET_NAME (ch)))) {
+    log ("Char has no data in file!");
+    save_char (ch, NOWHERE);
+    return;
+  }
 
-  /* r+b is for Binary Reading/Writing */
-  if (!(fl = fopen (OBJ_SAVE_FILE, "r+b"))) {
-    perror ("Opening object file for Loading PC's objects");
+  rent_seek (ri->offset);
+  if (fread (&st, sizeof (st), 1, rent_fl) < 1 ||
+    st.num_objs < 0 || st.num_objs > (RENT_MIN_OBJS << ri->class)) {
+    log ("Error reading rent record.");
     WIN32CLEANUP
     exit (1);
   }
 
-  pos = 0;
-
-  while (!feof (fl) && !found) {
-    pos += fread (&st, sizeof (struct obj_file_u), 1, fl);
-    found = !str_cmp (st.owner, GET_NAME (ch));
+  /* A renter who could not pay for every whole day away loses it all */
+  days_passed = ((time (0) - st.last_update) / SECS_PER_REAL_DAY);
+
+  if ((st.total_cost * days_passed) > st.gold_left) {
+    sprintf (buf, "Dumping %s from rent file.", st.owner);
+    log_at (LOG_SAVE, LOG_INFO, buf);
+    send_to_char
+      ("Your rent ran out, and the receptionist has kept your belongings.\n\r",
+      ch);
+
+    GET_GOLD (ch) = 0;
+    ch->in_room = NOWHERE;
+    rent_release (ri);
+    save_char (ch, NOWHERE);
+    return;
   }
 
-  if (found) {
-
-    obj_store_to_char (ch, &st);
+  if (st.num_objs) {
+    CREATE (objs, struct rent_obj_u, st.num_objs);
+    if (fread (objs, sizeof (struct rent_obj_u), st.num_objs, rent_fl) <
+      (size_t) st.num_objs) {
+      log ("Error reading rent record.");
+      WIN32CLEANUP
+      exit (1);
+    }
+  }
 
-    /* To avoid overflow of int */
+  obj_store_to_char (ch, &st, objs);
+  if (objs)
+    free (objs);
 
-    timegold =
-      (unsigned) (((float) st.total_cost * (float) (time (0) -
-          st.last_update))
-      / (float) (SECS_PER_REAL_DAY));
+  /* To avoid overflow of int */
 
-    GET_GOLD (ch) -= timegold;
+  timegold =
+    (unsigned) (((float) st.total_cost * (float) (time (0) -
+        st.last_update))
+    / (float) (SECS_PER_REAL_DAY));
 
-    if (GET_GOLD (ch) < 0)
-      GET_GOLD (ch) = 0;
+  GET_GOLD (ch) -= timegold;
 
+  if (GET_GOLD (ch) < 0)
+    GET_GOLD (ch) = 0;
 
-    if (fseek (fl, sizeof (struct obj_file_u) * (pos - 1), 0)) {
-      perror ("seeking in PC objects file.");
-      WIN32CLEANUP
-      exit (1);
-    }
-    strcpy (st.owner, OBJ_FILE_FREE);
-    if (fwrite (&st, sizeof (struct obj_file_u), 1, fl) < 1) {
-      log ("Error updating name to be set as unused.");
-      WIN32CLEANUP
-      exit (1);
-    }
-
-  } else {
-    log ("Char has no data in file!");
-  }
-
-  fclose (fl);
+  rent_release (ri);
 
   /* Save char, to avoid strange data if crashing */
   save_char (ch, NOWHERE);
@@ -250,58 +454,70 @@ void load_char_objs (struct char_data *ch)
 * Routines used to save a characters equipment from disk                  *
 ************************************************************************* */
 
-/* Puts object in store, at first item which has no -1 */
-void put_obj_in_store (struct obj_data *obj, struct obj_file_u *st)
-{
-  int i, j;
-  bool found = FALSE;
-
-  for (i = 0; (i < MAX_OBJ_SAVE) && !found; i++)
-    if (st->objects[i].item_number == -1) {
-      st->objects[i].item_number = obj_index[obj->item_number].virtual;
-      st->objects[i].value[0] = obj->obj_flags.value[0];
-      st->objects[i].value[1] = obj->obj_flags.value[1];
-      st->objects[i].value[2] = obj->obj_flags.value[2];
-      st->objects[i].value[3] = obj->obj_flags.value[3];
-
-      st->objects[i].extra_flags = obj->obj_flags.extra_flags;
-      st->objects[i].weight = obj->obj_flags.weight;
-      st->objects[i].timer = obj->obj_flags.timer;
-      st->objects[i].bitvector = obj->obj_flags.bitvector;
-      for (j = 0; j < MAX_OBJ_AFFECT; j++)
-        st->objects[i].affected[j] = obj->affected[j];
-      found = TRUE;
-    }
-
-  if (!found) {
-    log ("No empty space to store object. (put_obj_in_store, reception.c)");
-    exit (1);
-  }
-}
-
+struct rent_objs {
+  struct rent_obj_u *obj;
+  int num;
+  int size;
+};
 
 
-/* Destroy inventory after transferring it to "store inventory" */
-void obj_to_store (struct obj_data *obj, struct obj_file_u *st,
+/* Store obj, its contents and the objects after it, then destroy them.
+   A container's slot is taken first so its contents can name it, and
+   filled in once they are out of it and its weight is its own again. */
+void obj_to_store (struct obj_data *obj, int in_obj, struct rent_objs *ro,
   struct char_data *ch)
 {
   static char buf[240];
+  struct obj_file_elem *elem;
+  struct obj_data *next;
+  int i, j;
 
-  if (obj) {
-    obj_to_store (obj->contains, st, ch);
-    obj_to_store (obj->next_content, st, ch);
+  for (; obj; obj = next) {
+    next = obj->next_content;
+
+    obj_timer_sync (obj);
 
     if ((obj->obj_flags.timer < 0) && (obj->obj_flags.timer != OBJ_NOTIMER)) {
       sprintf (buf,
         "You're told: 'The %s is just old junk, I'll throw it away for you.'\n\r",
         fname (obj->name));
       send_to_char (buf, ch);
-    } else {
-      put_obj_in_store (obj, st);
+      obj_to_store (obj->contains, in_obj, ro, ch);
       if (obj->in_obj)
         obj_from_obj (obj);
       extract_obj (obj);
+      continue;
+    }
+
+    if (ro->num >= ro->size) {
+      ro->size = ro->size ? ro->size * 2 : RENT_MIN_OBJS;
+      if (ro->obj)
+        RECREATE (ro->obj, struct rent_obj_u, ro->size);
+      else
+        CREATE (ro->obj, struct rent_obj_u, ro->size);
     }
+    i = ro->num++;
+
+    obj_to_store (obj->contains, i, ro, ch);
+
+    elem = &ro->obj[i].obj;
+    ro->obj[i].in_obj = in_obj;
+    elem->item_number = obj_index[obj->item_number].virtual;
+    elem->value[0] = obj->obj_flags.value[0];
+    elem->value[1] = obj->obj_flags.value[1];
+    elem->value[2] = obj->obj_flags.value[2];
+    elem->value[3] = obj->obj_flags.value[3];
+
+    elem->extra_flags = obj->obj_flags.extra_flags;
+    elem->weight = obj->obj_flags.weight;
+    elem->timer = obj->obj_flags.timer;
+    elem->bitvector = obj->obj_flags.bitvector;
+    for (j = 0; j < MAX_OBJ_AFFECT; j++)
+      elem->affected[j] = obj->affected[j];
+
+    if (obj->in_obj)
+      obj_from_obj (obj);
+    extract_obj (obj);
   }
 }
 
@@ -310,165 +526,93 @@ void obj_to_store (struct obj_data *obj, struct obj_file_u *st,
 /* write the vital data of a player to the player file */
 void save_obj (struct char_data *ch, struct obj_cost *cost)
 {
-  struct obj_file_u st, dummy;
-  FILE *fl;
-  int pos, i, j;
-  bool found = FALSE;
-
-
-  for (j = 0; j < MAX_OBJ_SAVE; j++) {
-    st.objects[j].item_number = -1;     /* Set as not used */
-    st.objects[j].value[0] = 0;
-    st.objects[j].value[1] = 0;
-    st.objects[j].value[2] = 0;
-    st.objects[j].value[3] = 0;
-    st.objects[j].extra_flags = 0;
-    st.objects[j].weight = 0;
-    st.objects[j].timer = 0;
-
-    st.objects[j].bitvector = 0;
-    for (i = 0; i < MAX_OBJ_AFFECT; i++) {
-      st.objects[j].affected[i].location = 0;
-      st.objects[j].affected[i].modifier = 0;
-    }
-
-  }
+  struct rent_file_u st;
+  struct rent_objs ro;
+  int i;
 
+  memset (&st, 0, sizeof (st));
+  memset (&ro, 0, sizeof (ro));
 
   strcpy (st.owner, GET_NAME (ch));
   st.gold_left = GET_GOLD (ch);
   st.total_cost = cost->total_cost;
   st.last_update = time (0);
 
-  obj_to_store (ch->carrying, &st, ch);
+  obj_to_store (ch->carrying, -1, &ro, ch);
+  ch->spec_count -= obj_specials (ch->carrying);
   ch->carrying = 0;
 
   for (i = 0; i < MAX_WEAR; i++)
-    if (ch->equipment[i]) {
-      obj_to_store (ch->equipment[i], &st, ch);
-      unequip_char (ch, i);
-    }
-
-  if (!(fl = fopen (OBJ_SAVE_FILE, "a+b"))) {
-    perror ("saving PC's objects");
-    WIN32CLEANUP
-    exit (1);
-  }
-
-
-  if (fseek (fl, 0, 0)) {       /* Move to beginning of file */
-    perror ("seeking to start of PC objects file.");
-    WIN32CLEANUP
-    exit (1);
-  }
+    if (ch->equipment[i])
+      obj_to_store (unequip_char (ch, i), -1, &ro, ch);
 
-  pos = 0;
+  st.num_objs = ro.num;
+  rent_store (&st, ro.obj);
 
-  while (!feof (fl) && !found) {
-    pos += fread (&dummy, sizeof (struct obj_file_u), 1, fl);
-    found = (dummy.owner[0] == '\0');
-  }
-
-  if (feof (fl))
-    update_file (fl, pos, &st);
-  else {
-    if (!found) {
-      perror ("Really strange...\n\r");
-      WIN32CLEANUP
-      exit (1);
-    }
-
-    update_file (fl, pos - 1, &st);
-  }
-
-  fclose (fl);
+  if (ro.obj)
+    free (ro.obj);
 }
 
 
 
 /* ************************************************************************
-* Routines used to update object file, upon boot time                     *
+* Routines used to open the rent file, upon boot time                     *
 ************************************************************************* */
 
+/* Open the rent file, moving the old object file into it the first time,
+   and index it.  Only the record headers are read; the rent itself is
+   charged when the renter comes back, in load_char_objs. */
 void update_obj_file (void)
 {
-  FILE *fl, *char_file;
-  struct obj_file_u st;
-  struct char_file_u ch_st;
-  struct char_data tmp_char;
-  int pos, no_read, player_i;
-  long days_passed, secs_lost;
+  struct rent_file_u st;
+  struct rent_index *ri;
+  int class, renters = 0;
+  long offset;
   char buf[MAX_STRING_LENGTH];
 
-  int find_name (char *name);
-  extern struct player_index_element *player_table;
-
-  if (!(char_file = fopen (PLAYER_FILE, "r+b"))) {
-    perror
-      ("   Opening player file for reading. (reception.c, update_obj_file)");
-    WIN32CLEANUP
-    exit (1);
-  }
-
   /* r+b is for Binary Reading/Writing */
-  if (!(fl = fopen (OBJ_SAVE_FILE, "r+b"))) {
-    perror ("   Opening object file for updating");
-    WIN32CLEANUP
-    exit (1);
+  if (!(rent_fl = fopen (RENT_FILE, "r+b"))) {
+    if (!(rent_fl = fopen (RENT_FILE, "w+b"))) {
+      perror ("   Creating rent file");
+      WIN32CLEANUP
+      exit (1);
+    }
+    rent_migrate ();
+    rent_clear ();
   }
 
+  for (offset = 0;; offset += RENT_SIZE (class)) {
+    rent_seek (offset);
+    if (fread (&st, sizeof (st), 1, rent_fl) < 1)
+      break;
+
+    for (class = 0; class < RENT_CLASSES &&
+      (RENT_MIN_OBJS << class) != st.max_objs; class++);
+    if (class >= RENT_CLASSES) {
+      sprintf (buf, "   Bad rent record at %ld; ignoring the rest.", offset);
+      log_at (LOG_SAVE, LOG_WARN, buf);
+      break;
+    }
 
-  pos = 0;
-
-  while (!feof (fl)) {
-    no_read = fread (&st, sizeof (struct obj_file_u), 1, fl);
-    pos += no_read;
-
-    if ((!feof (fl)) && (no_read > 0) && st.owner[0]) {
-      sprintf (buf, "   Processing %s[%d].", st.owner, pos);
-      log (buf);
-      days_passed = ((time (0) - st.last_update) / SECS_PER_REAL_DAY);
-      secs_lost = ((time (0) - st.last_update) % SECS_PER_REAL_DAY);
-
-      if (days_passed > 0) {
-        if ((st.total_cost * days_passed) > st.gold_left) {
-
-          if ((player_i = find_name (st.owner)) < 0) {
-            perror ("   Character not in list. (update_obj_file)");
-            exit (1);
-          }
-
-          fseek (char_file, (long) (player_table[player_i].nr *
-              sizeof (struct char_file_u)), 0);
-
-          fread (&ch_st, sizeof (struct char_file_u), 1, char_file);
-
-          sprintf (buf, "   Dumping %s from object file.", ch_st.name);
-          log (buf);
-
-          ch_st.points.gold = 0;
-          ch_st.load_room = NOWHERE;
-          fseek (char_file, (long) (player_table[player_i].nr *
-              sizeof (struct char_file_u)), 0);
-          fwrite (&ch_st, sizeof (struct char_file_u), 1, char_file);
-
-          strcpy (st.owner, OBJ_FILE_FREE);
-          update_file (fl, pos - 1, &st);
-
-        } else {
+    CREATE (ri, struct rent_index, 1);
+    ri->offset = offset;
+    ri->class = class;
 
-          sprintf (buf, "   Updating %s", st.owner);
-          log (buf);
-          st.gold_left -= (st.total_cost * days_passed);
-          st.last_update = time (0) - secs_lost;
-          update_file (fl, pos - 1, &st);
-        }
-      }
+    if (!st.owner[0] || rent_find (st.owner)) {
+      ri->next = rent_free[class];
+      rent_free[class] = ri;
+    } else {
+      strcpy (ri->owner, st.owner);
+      ri->next = rent_hash[rent_hash_name (st.owner)];
+      rent_hash[rent_hash_name (st.owner)] = ri;
+      renters++;
     }
   }
 
-  fclose (fl);
-  fclose (char_file);
+  rent_end = offset;
+
+  sprintf (buf, "   %d renters.", renters);
+  log (buf);
 }
 
 
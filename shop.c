@@ -20,6 +20,7 @@
 
 extern struct str_app_type str_app[];
 extern struct index_data *mob_index;
+extern struct index_data *obj_index;
 
 char *fread_string (FILE * fl);
 
@@ -177,6 +178,9 @@ void shopping_buy (char *arg, struct char_data *ch,
   do_tell (keeper, buf, 19);
   sprintf (buf, "You now have %s.\n\r", temp1->short_description);
   send_to_char (buf, ch);
+  EVENT (EVENT_BUY, ch, obj_index[temp1->item_number].virtual,
+    (int) (temp1->obj_flags.cost * shop_index[shop_nr].profit_buy),
+    event_id (keeper));
   if (GET_LEVEL (ch) < 22)
     GET_GOLD (ch) -= (int) (temp1->obj_flags.cost *
       shop_index[shop_nr].profit_buy);
@@ -240,6 +244,10 @@ void shopping_sell (char *arg, struct char_data *ch,
   do_tell (keeper, buf, 19);
   sprintf (buf, "The shopkeeper now has %s.\n\r", temp1->short_description);
   send_to_char (buf, ch);
+  EVENT (EVENT_SELL, ch, temp1->item_number >= 0 ?
+    obj_index[temp1->item_number].virtual : -1,
+    (int) (temp1->obj_flags.cost * shop_index[shop_nr].profit_sell),
+    event_id (keeper));
   GET_GOLD (ch) += (int) (temp1->obj_flags.cost *
     shop_index[shop_nr].profit_sell);
   GET_GOLD (keeper) -= (int) (temp1->obj_flags.cost *
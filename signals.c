@@ -56,6 +56,7 @@ void checkpointing (int sig)
 
   if (!tics) {
     log ("CHECKPOINT shutdown: tics not updated");
+    log_flush ();
     abort ();
   } else
     tics = 0;
@@ -11,9 +11,34 @@
 extern struct room_data *world;
 extern struct index_data *mob_index;
 extern struct index_data *obj_index;
+extern int top_of_mobt;
+extern int top_of_objt;
+
 void boot_the_shops (void);
 void assign_the_shopkeepers (void);
 
+
+/* Commands a special procedure answers to, ending with 0.  special()
+   will not offer it any other command, and a holder whose list is empty
+   does not count towards the room's spec_count at all.  Procedures with
+   no list here are offered every command. */
+
+static int no_commands[] = { 0 };       /* acts only from mobile_activity() */
+static int move_commands[] = { 1, 2, 3, 4, 5, 6, 0 };
+static int guild_commands[] = { 164, 170, 0 };  /* practice, practise */
+static int shop_commands[] = { 56, 57, 58, 59, 0 };     /* buy, sell, value, list */
+static int board_commands[] = { 15, 63, 66, 149, 0 };   /* look, read, remove, write */
+
+static void spec_commands (struct index_data *index, int top,
+  int (*func) (struct char_data *ch, int cmd, char *arg), int *cmds)
+{
+  int i;
+
+  for (i = 0; i <= top; i++)
+    if (index[i].func == func)
+      index[i].cmds = cmds;
+}
+
 /* ********************************************************************
 *  Assignments                                                        *
 ******************************************************************** */
@@ -37,6 +62,7 @@ void assign_mobiles (void)
   int bat_green (struct char_data *ch, int cmd, char *arg);
   int bat_black (struct char_data *ch, int cmd, char *arg);
   int bat_white (struct char_data *ch, int cmd, char *arg);
+  int shop_keeper (struct char_data *ch, int cmd, char *arg);
 
 
   mob_index[real_mobile (1)].func = puff;
@@ -94,6 +120,23 @@ void assign_mobiles (void)
 
   boot_the_shops ();
   assign_the_shopkeepers ();
+
+  spec_commands (mob_index, top_of_mobt, puff, no_commands);
+  spec_commands (mob_index, top_of_mobt, cityguard, no_commands);
+  spec_commands (mob_index, top_of_mobt, janitor, no_commands);
+  spec_commands (mob_index, top_of_mobt, fido, no_commands);
+  spec_commands (mob_index, top_of_mobt, mayor, no_commands);
+  spec_commands (mob_index, top_of_mobt, snake, no_commands);
+  spec_commands (mob_index, top_of_mobt, thief, no_commands);
+  spec_commands (mob_index, top_of_mobt, magic_user, no_commands);
+  spec_commands (mob_index, top_of_mobt, bat_red, no_commands);
+  spec_commands (mob_index, top_of_mobt, bat_blue, no_commands);
+  spec_commands (mob_index, top_of_mobt, bat_green, no_commands);
+  spec_commands (mob_index, top_of_mobt, bat_black, no_commands);
+  spec_commands (mob_index, top_of_mobt, bat_white, no_commands);
+  spec_commands (mob_index, top_of_mobt, guild, guild_commands);
+  spec_commands (mob_index, top_of_mobt, guild_guard, move_commands);
+  spec_commands (mob_index, top_of_mobt, shop_keeper, shop_commands);
 }
 
 
@@ -104,6 +147,8 @@ void assign_objects (void)
   int board (struct char_data *ch, int cmd, char *arg);
 
   obj_index[real_object (3099)].func = board;
+
+  spec_commands (obj_index, top_of_objt, board, board_commands);
 }
 
 
@@ -1090,6 +1090,7 @@ int pet_shops (struct char_data *ch, int cmd, char *arg)
     if (*pet_name) {
       sprintf (buf, "%s %s", pet->player.name, pet_name);
       free (pet->player.name);
+      keywords_free (&pet->keywords);
       pet->player.name = str_dup (buf);
 
       sprintf (buf,
@@ -166,26 +166,20 @@ const byte saving_throws[4][5][25] = {
 
 void affect_update (void)
 {
-  static struct affected_type *af, *next_af_dude;
-  static struct char_data *i;
-
-  for (i = character_list; i; i = i->next)
-    for (af = i->affected; af; af = next_af_dude) {
-      next_af_dude = af->next;
-      if (af->duration >= 1)
-        af->duration--;
-      else {
-        if ((af->type > 0) && (af->type <= 52)) /* It must be a spell */
-          if (!af->next || (af->next->type != af->type) ||
-            (af->next->duration > 0))
-            if (*spell_wear_off_msg[af->type]) {
-              send_to_char (spell_wear_off_msg[af->type], i);
-              send_to_char ("\n\r", i);
-            }
+  struct affected_type *af;
+  struct char_data *i;
+
+  while ((af = affect_due (&i))) {
+    if ((af->type > 0) && (af->type <= 52))     /* It must be a spell */
+      if (!af->next || (af->next->type != af->type) ||
+        affect_outlasts_hour (af->next))
+        if (*spell_wear_off_msg[af->type]) {
+          send_to_char (spell_wear_off_msg[af->type], i);
+          send_to_char ("\n\r", i);
+        }
 
-        affect_remove (i, af);
-      }
-    }
+    affect_remove (i, af);
+  }
 }
 
 
@@ -276,6 +270,10 @@ void clone_obj (struct obj_data *obj)
   clone->contains = 0;
   clone->next_content = 0;
   clone->next = 0;
+  clone->timer.owner = 0;
+  clone->keywords.source = 0;
+  clone->keywords.num = 0;
+  clone->keywords.word = 0;
 
   /* VIRKER IKKE ENDNU */
 }
@@ -472,7 +470,7 @@ bool saves_spell (struct char_data *ch, sh_int save_type)
       return (TRUE);
   }
 
-  return (MAX (1, save) < number (1, 20));
+  return (MAX (1, save) < rng_number (RNG_COMBAT, 1, 20));
 }
 
 
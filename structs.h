@@ -12,6 +12,7 @@ typedef char byte;
 
 #define PULSE_ZONE     240
 #define PULSE_MOBILE    40
+#define ZONE_DORMANT_RATE 8      /* Mobile pulses per pass of an idle zone */
 #define PULSE_VIOLENCE  12
 #define WAIT_SEC       4
 #define WAIT_ROUND     4
@@ -150,6 +151,27 @@ struct obj_affected_type {
   sbyte modifier;               /* How much it changes by              */
 };
 
+/* Entry on one of the expiry heaps kept in handler.c */
+/* A namelist split into its words once, for matching with isname() rules */
+struct keyword {
+  unsigned long hash;           /* of the word, lowercased */
+  int offset;                   /* where it starts in the namelist */
+  int length;
+};
+
+struct keyword_set {
+  char *source;                 /* namelist the words were taken from */
+  int num;
+  struct keyword *word;
+};
+
+struct timer_node {
+  long expires;                 /* Mud hour when the timer runs out */
+  long seq;                     /* Order of insertion, breaks ties  */
+  int heap_pos;                 /* Slot in the heap                 */
+  void *owner;                  /* What is timed, NULL if not queued */
+};
+
 /* ======================== Structure for object ========================= */
 struct obj_data {
   sh_int item_number;           /* Where in data-base               */
@@ -170,6 +192,9 @@ struct obj_data {
 
   struct obj_data *next_content;        /* For 'contains' lists             */
   struct obj_data *next;        /* For the object list              */
+
+  struct timer_node timer;      /* Decay / burn out schedule        */
+  struct keyword_set keywords;  /* Words of name                    */
 };
 /* ======================================================================= */
 
@@ -236,7 +261,9 @@ struct room_data {
   struct room_direction_data *dir_option[6];    /* Directions           */
   sh_int room_flags;            /* DEATH,DARK ... etc                 */
   byte light;                   /* Number of lightsources in room     */
+  byte visibility;              /* SIGHT_LIGHT while dark, see room_light */
   int (*funct) (struct char_data *ch, int cmd, char *arg);   /* special procedure                  */
+  int spec_count;               /* Mobiles/objects here with a special */
 
   struct obj_data *contents;    /* List of items in room              */
   struct char_data *people;     /* List of NPC / PC in room           */
@@ -279,6 +306,12 @@ struct room_data {
 #define FULL         1
 #define THIRST       2
 
+/* What it takes to see something, kept from 'affected_by' and room light
+   by update_sight() and room_light(); see CAN_SEE() */
+#define SIGHT_EYES            1 /* not blind; needed to see anything */
+#define SIGHT_INVISIBLE       2 /* detect invisible */
+#define SIGHT_LIGHT           4 /* needed in a dark room; nobody has it */
+
 /* Bitvector for 'affected_by' */
 #define AFF_BLIND             1
 #define AFF_INVISIBLE         2
@@ -428,6 +461,15 @@ struct char_ability_data {
   sbyte con;
 };
 
+/* sums of the APPLY_ modifiers to abilities now in effect */
+struct char_apply_data {
+  int str;
+  int intel;
+  int wis;
+  int dex;
+  int con;
+};
+
 
 /* Used in CHAR_FILE_U *DO*NOT*CHANGE* */
 struct char_point_data {
@@ -452,6 +494,8 @@ struct char_special_data {
   struct char_data *hunting;    /* Hunting person..                     */
 
   long affected_by;             /* Bitvector for spells/skills affected by */
+  byte sight;                   /* SIGHT_ bits this char sees with         */
+  byte visibility;              /* SIGHT_ bits it takes to see this char   */
 
   byte position;                /* Standing or ...                         */
   byte default_pos;             /* Default position for NPC                */
@@ -493,6 +537,14 @@ struct affected_type {
   struct affected_type *next;
 };
 
+/* In memory every affected_type on a char is the head of one of these, */
+/* so affect_update() can pull only the affects that are due this hour.  */
+struct affect_timer {
+  struct affected_type af;      /* Must be first, ch->affected uses it     */
+  struct char_data *ch;         /* Who carries the affect                  */
+  struct timer_node node;       /* Place on the affect expiry heap         */
+};
+
 struct follow_type {
   struct char_data *follower;
   struct follow_type *next;
@@ -506,6 +558,7 @@ struct char_data {
   struct char_player_data player;       /* Normal data                   */
   struct char_ability_data abilities;   /* Abilities                     */
   struct char_ability_data tmpabilities;        /* The abilities we will use     */
+  struct char_apply_data applied;       /* Modifiers from items and spells */
   struct char_point_data points;        /* Points                        */
   struct char_special_data specials;    /* Special plaing constants      */
   struct char_skill_data skills[MAX_SKILLS];    /* Skills                   */
@@ -514,14 +567,20 @@ struct char_data {
   struct obj_data *equipment[MAX_WEAR]; /* Equipment array               */
 
   struct obj_data *carrying;    /* Head of list                  */
+  int spec_count;               /* Carried/worn objects with a special */
   struct descriptor_data *desc; /* NULL for mobiles              */
 
   struct char_data *next_in_room;       /* For room->people - list         */
+  struct char_data *next_in_zone;       /* For zone->mobs - list           */
+  struct char_data *prev_in_zone;
+  int acted;                    /* Mobile pulse it last acted in   */
   struct char_data *next;       /* For either monster or ppl-list  */
   struct char_data *next_fighting;      /* For fighting list               */
 
   struct follow_type *followers;        /* List of chars followers       */
   struct char_data *master;     /* Who is char following?        */
+
+  struct keyword_set keywords;  /* Words of player.name          */
 };
 
 
@@ -623,14 +682,140 @@ struct obj_file_u {
   struct obj_file_elem objects[MAX_OBJ_SAVE];
 };
 
+
+/* ***********************************************************************
+*  The rent file, which replaces the object file above: a record for    *
+*  each renter, made of a header and room for max_objs objects.  Each   *
+*  object names the object it was inside of, so containers keep their   *
+*  contents.  BEWARE: Changing these will ruin the file                 *
+*********************************************************************** */
+
+#define MAX_RENT_OBJS 200       /* Most objects one player may rent   */
+
+struct rent_file_u {
+  char owner[20];               /* Name of player, "" if unused       */
+  int gold_left;                /* Number of goldcoins left at owner  */
+  int total_cost;               /* The cost for all items, per day    */
+  long last_update;             /* Time in seconds, when last updated */
+  int num_objs;                 /* Objects stored                     */
+  int max_objs;                 /* Objects there is room for          */
+};
+
+struct rent_obj_u {
+  struct obj_file_elem obj;
+  int in_obj;                   /* Index of its container, or -1      */
+};
+
+
+/* ***********************************************************************
+*  The world image, the live state of the world as of a snapshot: zone  *
+*  ages, doors, mobiles and the objects not held by players.  Rooms,    *
+*  mobiles and objects are named by virtual number.  An object is in a  *
+*  room, carried or worn by the n'th mobile, or in the n'th object.     *
+*********************************************************************** */
+
+#define WORLD_IMAGE_MAGIC   0x444c5257L
+#define WORLD_IMAGE_VERSION 2
+
+#define IMAGE_IN_ROOM 0
+#define IMAGE_CARRIED 1
+#define IMAGE_WORN    2
+#define IMAGE_IN_OBJ  3
+
+/* item numbers of the objects made by the game rather than the files */
+#define IMAGE_CORPSE  -2
+#define IMAGE_MONEY   -3
+
+struct world_image_head {
+  long magic;
+  int version;
+  int record_size;              /* Sum of the record sizes below      */
+  long saved;                   /* Time in seconds of the snapshot    */
+  int num_rooms;                /* Of the world it was taken from     */
+  int num_zones;
+  int num_doors;
+  int num_mobs;
+  int num_objs;
+};
+
+struct world_door_u {
+  sh_int room;                  /* Virtual number                     */
+  sh_int dir;
+  sh_int exit_info;
+};
+
+struct world_mob_u {
+  sh_int item_number;           /* Virtual number                     */
+  sh_int room;                  /* Virtual number                     */
+  struct char_point_data points;
+  int alignment;
+  byte position;
+  ubyte act;
+};
+
+struct world_obj_u {
+  struct obj_file_elem obj;     /* Weight without the contents        */
+  sh_int where;                 /* IMAGE_ constant                    */
+  sh_int wear_pos;              /* If IMAGE_WORN                      */
+  int in;                       /* Room vnum, mobile or object index  */
+  char short_descr[80];         /* If IMAGE_CORPSE                    */
+};
+
+
+/* ***********************************************************************
+*  The event stream, fixed size records of what happens in the game,    *
+*  written when the game is started with -e file and read back with the *
+*  events tool.  A mobile is named by its virtual number, a player by   *
+*  -1 - its place in the player file, and nobody by 0.  Every file      *
+*  starts with an EVENT_FILE record, as does every restart of the game. *
+*********************************************************************** */
+
+#define EVENT_MAGIC   0x544e5645L
+#define EVENT_VERSION 1
+
+                                /* actor     target    value    extra    */
+#define EVENT_FILE    0         /* magic     rec size  version  -        */
+#define EVENT_DAMAGE  1         /* attacker  victim    damage   attack   */
+#define EVENT_KILL    2         /* killer    victim    level    -        */
+#define EVENT_DEATH   3         /* the dead  -         level    -        */
+#define EVENT_EXP     4         /* gainer    -         gain     new exp  */
+#define EVENT_LOOT    5         /* looter    obj vnum  cost     coins    */
+#define EVENT_RESET   6         /* -         zone      mobiles  objects  */
+#define EVENT_LOGIN   7         /* player    -         level    EV_LOGIN */
+#define EVENT_BUY     8         /* buyer     obj vnum  price    keeper   */
+#define EVENT_SELL    9         /* seller    obj vnum  price    keeper   */
+#define MAX_EVENT     10
+
+#define EV_LOGIN_OLD  0
+#define EV_LOGIN_NEW  1
+#define EV_LOGIN_BACK 2         /* Reconnected to a link dead char    */
+
+struct event_u {
+  long time;                    /* In seconds                         */
+  int pulse;                    /* Since the game was started         */
+  sh_int type;                  /* EVENT_ constant                    */
+  sh_int room;                  /* Virtual number, or -1              */
+  int actor;
+  int target;
+  int value;
+  int extra;
+};
+
 /* ***********************************************************
 *  The following structures are related to descriptor_data   *
 *********************************************************** */
 
 
 
+/* text sent to many queues at once, freed when the last one is done */
+struct txt_shared {
+  int refs;
+  char *text;
+};
+
 struct txt_block {
   char *text;
+  struct txt_shared *shared;    /* owner of text, if not ours alone */
   struct txt_block *next;
 };
 
@@ -658,6 +843,17 @@ struct txt_q {
 #define CON_PWDNEW  12
 #define CON_PWDNCNF 13
 
+/* a text being paged through by a descriptor */
+struct pager {
+  char *text;                   /* start of the text; not terminated */
+  int own;                      /* text was copied for us and is freed */
+  int *line;                    /* offset of each line in text, plus the end */
+  int num_lines;
+  int page;                     /* page now on screen, from 0 */
+};
+
+#define PAGE_LINES  22
+
 struct snoop_data {
   struct char_data *snooping;
   /* Who is this char snooping */
@@ -672,10 +868,11 @@ struct descriptor_data {
   int pos;                      /* position in player-file    */
   int connected;                /* mode of 'connectedness'    */
   int wait;                     /* wait for how many loops    */
-  char *showstr_head;           /* for paging through texts */
-  char *showstr_point;          /*       -                    */
+  struct pager *pager;          /* for paging through texts   */
   char **str;                   /* for the modify-str system  */
+  struct keyword_set *str_keywords;     /* words of *str, if a name */
   int max_str;                  /* -                          */
+  void (*str_done) (char **str);        /* called when *str is done   */
   int prompt_mode;              /* control of prompt-printing */
   char buf[MAX_STRING_LENGTH];  /* buffer for raw input       */
   char last_input[MAX_INPUT_LENGTH];    /* the last input         */
@@ -691,6 +888,9 @@ struct msg_type {
   char *attacker_msg;           /* message to attacker */
   char *victim_msg;             /* message to victim   */
   char *room_msg;               /* message to room     */
+  struct act_template *attacker_act;    /* the same, compiled for act() */
+  struct act_template *victim_act;
+  struct act_template *room_act;
 };
 
 struct message_type {
@@ -699,13 +899,12 @@ struct message_type {
   struct msg_type hit_msg;      /* messages when hit              */
   struct msg_type sanctuary_msg;        /* messages when hit on sanctuary */
   struct msg_type god_msg;      /* messages when hit on god       */
-  struct message_type *next;    /* to next messages of this kind. */
 };
 
 struct message_list {
   int a_type;                   /* Attack type             */
   int number_of_attacks;        /* How many attack messages to chose from. */
-  struct message_type *msg;     /* List of messages.         */
+  struct message_type *msg;     /* Array of messages.        */
 };
 
 struct dex_skill_type {
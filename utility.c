@@ -8,6 +8,7 @@
 
 #include "structs.h"
 #include "utils.h"
+#include "db.h"
 
 extern struct time_data time_info;
 
@@ -25,16 +26,92 @@ int MAX (int a, int b)
 }
 #endif
 
-/* creates a random number in interval [from;to] */
-int number (int from, int to)
+/* Random numbers. Each subsystem (RNG_XXX in utils.h) draws from its own
+   xoshiro128** generator, so combat or mob AI can be replayed from a seed
+   without the rest of the game disturbing the sequence. The state words
+   are kept in unsigned longs masked to 32 bits, since not all of our
+   compilers have a 64 bit integer type.                                  */
+
+#define U32(x) ((x) & 0xFFFFFFFFUL)
+#define ROTL32(x, k) U32(((x) << (k)) | (U32(x) >> (32 - (k))))
+
+static unsigned long rng_state[MAX_RNG][4];
+
+/* splitmix32, only used to spread one seed over all the state words */
+static unsigned long rng_mix (unsigned long *x)
 {
-  return ((OS_RAND () % (to - from + 1)) + from);
+  unsigned long z;
+
+  z = *x = U32 (*x + 0x9E3779B9UL);
+  z = U32 ((z ^ (z >> 16)) * 0x85EBCA6BUL);
+  z = U32 ((z ^ (z >> 13)) * 0xC2B2AE35UL);
+  return (z ^ (z >> 16));
 }
 
 
 
-/* simulates dice roll */
-int dice (int number, int size)
+/* Seed every stream from one number; the same seed gives the same game */
+void rng_seed (unsigned long seed)
+{
+  int i, j;
+
+  seed = U32 (seed);
+  for (i = 0; i < MAX_RNG; i++)
+    for (j = 0; j < 4; j++)
+      rng_state[i][j] = rng_mix (&seed);
+}
+
+
+
+/* Next 32 bit output of a stream */
+static unsigned long rng_next (int stream)
+{
+  unsigned long *s = rng_state[stream];
+  unsigned long result, t;
+
+  result = U32 (ROTL32 (U32 (s[1] * 5), 7) * 9);
+  t = U32 (s[1] << 9);
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = ROTL32 (s[3], 11);
+
+  return (result);
+}
+
+
+
+/* A number in [0;range-1] with no modulo bias; range must be >= 1 */
+static unsigned long rng_below (int stream, unsigned long range)
+{
+  unsigned long r, limit;
+
+  /* Throw away the top partial block of outputs */
+  limit = U32 (0xFFFFFFFFUL - range + 1) % range;
+  do
+    r = rng_next (stream);
+  while (r < limit);
+
+  return (r % range);
+}
+
+
+
+/* creates a random number in interval [from;to] from a given stream */
+int rng_number (int stream, int from, int to)
+{
+  if (to <= from)
+    return (from);
+  return (from + (int) rng_below (stream, (unsigned long) (to - from) + 1));
+}
+
+
+
+/* simulates dice roll on a given stream */
+int rng_dice (int stream, int number, int size)
 {
   int r;
   int sum = 0;
@@ -42,12 +119,28 @@ int dice (int number, int size)
   assert (size >= 1);
 
   for (r = 1; r <= number; r++)
-    sum += ((OS_RAND () % size) + 1);
+    sum += (int) rng_below (stream, (unsigned long) size) + 1;
   return (sum);
 }
 
 
 
+/* creates a random number in interval [from;to] */
+int number (int from, int to)
+{
+  return (rng_number (RNG_WORLD, from, to));
+}
+
+
+
+/* simulates dice roll */
+int dice (int number, int size)
+{
+  return (rng_dice (RNG_WORLD, number, size));
+}
+
+
+
 /* Create a duplicate of a string */
 char *str_dup (char *source)
 {
@@ -94,16 +187,424 @@ int strn_cmp (char *arg1, char *arg2, int n)
 
 
 
+/* The log and the event stream.  log() and log_at() copy the line, and
+   event() the record, into a ring buffer and return, and a writer thread
+   writes the rings out: the log to stderr, or to the file given to
+   log_open(), and the events to the file given to event_open().  Both
+   files are rotated by size.  The game is the only one to fill a ring
+   and the writer the only one to empty it, so each end has a single
+   owner and no lock is needed.  The time is taken once a pulse, by
+   log_pulse(), which also hands the pulse's events to the writer all
+   at once.  Without threads (WIN32) the game empties the rings itself,
+   each pulse or when one is full.                                      */
+
+#define LOG_RING_SIZE   65536L  /* a power of two */
+#define LOG_LINE_MAX    (LOG_RING_SIZE / 4)
+#define LOG_ROTATE_SIZE (4L * 1024L * 1024L)
+#define LOG_ROTATE_KEEP 5       /* file.1 .. file.5 */
+#define EVENT_RING_SIZE 262144L /* a power of two */
+#define EVENT_ROTATE_SIZE (16L * 1024L * 1024L)
+
+struct log_ring {
+  char *buf;
+  unsigned long size;
+  volatile unsigned long head;  /* filled up to, for the writer */
+  volatile unsigned long tail;  /* written up to, by the writer */
+  unsigned long fill;           /* filled up to, not yet shown to it */
+  int fd;
+  int spare_fd;                 /* if the file cannot be opened */
+  long written;                 /* to the file so far */
+  long rotate;                  /* at this size */
+  char *path;                   /* of the file, "" for none */
+  void (*start) (struct log_ring * ring);       /* begins each file */
+};
+
+char *log_systems[] = { "game", "boot", "connect", "commands", "save", "\n" };
+char *log_levels[] = { "debug", "info", "warn", "error", "off", "\n" };
+int log_level[MAX_LOG] = { LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO, LOG_INFO };
+char log_path[MAXPATHLEN] = "";
+char event_path[MAXPATHLEN] = "";
+int event_stream = FALSE;
+
+static void event_start (struct log_ring *ring);
+
+static char log_buf[LOG_RING_SIZE];
+static char event_buf[EVENT_RING_SIZE];
+static struct log_ring log_out = { log_buf, LOG_RING_SIZE, 0, 0, 0, 2, 2,
+  0, LOG_ROTATE_SIZE, log_path, 0
+};
+static struct log_ring event_out = { event_buf, EVENT_RING_SIZE, 0, 0, 0,
+  -1, -1, 0, EVENT_ROTATE_SIZE, event_path, event_start
+};
+
+static volatile int log_busy = FALSE;   /* in log_at(), for signal handlers */
+static int log_threaded = FALSE;
+static int log_direct = TRUE;   /* write each line at once */
+static int log_pulsing = FALSE;
+static int log_pulses = 0;
+static time_t log_time = 0;
+static char log_stamp[32];
+
+#ifdef WIN32
+#define LOG_BARRIER()
+#else
+#define LOG_BARRIER() __sync_synchronize ()
+static pthread_t log_thread;
+static pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t log_wake = PTHREAD_COND_INITIALIZER;
+#endif
+
+void log_flush (void);
+
+
+static void log_stamp_update (void)
+{
+  time_t ct = time (0);
+
+  if (ct != log_time) {
+    log_time = ct;
+    strcpy (log_stamp, asctime (localtime (&ct)));
+    log_stamp[strlen (log_stamp) - 1] = '\0';
+  }
+}
+
+
+static void log_write (int fd, char *text, long length)
+{
+  long done;
+
+  for (; length > 0; text += done, length -= done)
+    if ((done = write (fd, text, length)) <= 0)
+      break;
+}
+
+
+/* open the ring's file for append; FALSE if it could not be done */
+static int log_file_open (struct log_ring *ring)
+{
+  struct stat st;
+
+  if ((ring->fd = open (ring->path, O_WRONLY | O_CREAT | O_APPEND,
+        0644)) < 0) {
+    ring->fd = ring->spare_fd;
+    return (FALSE);
+  }
+  ring->written = fstat (ring->fd, &st) ? 0 : st.st_size;
+  if (ring->start)
+    (*ring->start) (ring);
+  return (TRUE);
+}
+
+
+/* start the next file, keeping LOG_ROTATE_KEEP old ones */
+static void log_rotate (struct log_ring *ring)
+{
+  char from[MAXPATHLEN + 4], to[MAXPATHLEN + 4];
+  int i;
+
+  close (ring->fd);
+  for (i = LOG_ROTATE_KEEP - 1; i > 0; i--) {
+    sprintf (from, "%s.%d", ring->path, i);
+    sprintf (to, "%s.%d", ring->path, i + 1);
+    rename (from, to);
+  }
+  sprintf (to, "%s.1", ring->path);
+  rename (ring->path, to);
+
+  log_file_open (ring);
+}
+
+
+/* write out what is in the ring; only the writer calls this */
+static void log_ring_drain (struct log_ring *ring)
+{
+  unsigned long head, start, length;
+
+  while ((head = ring->head) != ring->tail) {
+    LOG_BARRIER ();
+    start = ring->tail & (ring->size - 1);
+    length = head - ring->tail;
+    if (start + length > ring->size)
+      length = ring->size - start;
+    log_write (ring->fd, ring->buf + start, length);
+    ring->written += length;
+    LOG_BARRIER ();
+    ring->tail += length;
+  }
+
+  /* the ring always ends in a whole line or record */
+  if (*ring->path && ring->written > ring->rotate)
+    log_rotate (ring);
+}
+
+
+static void log_drain (void)
+{
+  log_ring_drain (&log_out);
+  if (event_stream)
+    log_ring_drain (&event_out);
+}
+
+
+#ifndef WIN32
+static void *log_writer (void *arg)
+{
+  struct timespec wait;
+
+  pthread_mutex_lock (&log_mutex);
+  for (;;) {
+    wait.tv_sec = time (0) + 1;
+    wait.tv_nsec = 0;
+    pthread_cond_timedwait (&log_wake, &log_mutex, &wait);
+    pthread_mutex_unlock (&log_mutex);
+    log_drain ();
+    pthread_mutex_lock (&log_mutex);
+  }
+  return (0);
+}
+#endif
+
+
+static void log_wakeup (void)
+{
+#ifndef WIN32
+  if (log_threaded) {
+    pthread_cond_signal (&log_wake);
+    return;
+  }
+#endif
+  log_drain ();
+}
+
+
+/* hand what has been filled in to the writer */
+static void log_publish (struct log_ring *ring)
+{
+  if (ring->head != ring->fill) {
+    LOG_BARRIER ();
+    ring->head = ring->fill;
+  }
+}
+
+
+/* wait for length bytes to be free in the ring */
+static void log_ring_room (struct log_ring *ring, unsigned long length)
+{
+  while (ring->size - (ring->fill - ring->tail) < length) {
+    log_publish (ring);
+    log_wakeup ();
+#ifndef WIN32
+    sched_yield ();
+#endif
+  }
+}
+
+
+/* copy length bytes of text to the ring at offset from the fill */
+static void log_put (struct log_ring *ring, unsigned long offset,
+  char *text, unsigned long length)
+{
+  unsigned long start = (ring->fill + offset) & (ring->size - 1);
+
+  if (start + length > ring->size) {
+    memcpy (ring->buf + start, text, ring->size - start);
+    memcpy (ring->buf, text + ring->size - start,
+      length - (ring->size - start));
+  } else
+    memcpy (ring->buf + start, text, length);
+}
+
+
+/* log str for system at level, unless that system logs less */
+void log_at (int system, int level, char *str)
+{
+  unsigned long length, stamp;
+  char line[MAX_STRING_LENGTH];
+
+  if (level < log_level[system])
+    return;
+
+  /* at boot, in a signal handler while the game logs, or in a child */
+  if (log_direct || log_busy) {
+    log_stamp_update ();
+    sprintf (line, "%s :: %.*s\n", log_stamp, MAX_STRING_LENGTH - 40, str);
+    log_write (log_out.fd, line, strlen (line));
+    return;
+  }
+
+  log_busy = TRUE;
+  if (!log_pulsing)
+    log_stamp_update ();
+
+  stamp = strlen (log_stamp);
+  if ((length = strlen (str)) > LOG_LINE_MAX)
+    length = LOG_LINE_MAX;
+
+  log_ring_room (&log_out, stamp + length + 5);
+  log_put (&log_out, 0, log_stamp, stamp);
+  log_put (&log_out, stamp, " :: ", 4);
+  log_put (&log_out, stamp + 4, str, length);
+  log_put (&log_out, stamp + 4 + length, "\n", 1);
+  log_out.fill += stamp + length + 5;
+  log_publish (&log_out);
+
+  log_busy = FALSE;
+}
+
+
 /* writes a string to the log */
 void log (char *str)
 {
-  time_t ct;
-  char *tmstr;
+  log_at (LOG_GAME, LOG_INFO, str);
+}
+
+
+/* path made absolute, as the game leaves the directory it started in */
+static void log_path_set (char *path, char *file)
+{
+  *path = '\0';
+#ifndef WIN32
+  if (*file != '/' && strlen (file) + 2 < MAXPATHLEN &&
+    getcwd (path, MAXPATHLEN - strlen (file) - 2))
+    strcat (path, "/");
+#endif
+  strncat (path, file, MAXPATHLEN - strlen (path) - 1);
+}
+
+
+/* start logging through the ring, to file if given, else to stderr */
+void log_open (char *file)
+{
+  if (file) {
+    log_path_set (log_path, file);
+    if (!log_file_open (&log_out)) {
+      perror (log_path);
+      *log_path = '\0';
+    }
+  }
+
+#ifndef WIN32
+  if (!pthread_create (&log_thread, NULL, log_writer, NULL))
+    log_threaded = TRUE;
+#endif
+  log_direct = FALSE;
+  atexit (log_flush);
+}
+
+
+/* once a pulse: take the time, and have the rings written out */
+void log_pulse (void)
+{
+  log_pulsing = TRUE;
+  log_pulses++;
+  log_stamp_update ();
+  log_publish (&event_out);
+  if (log_out.head != log_out.tail || event_out.head != event_out.tail)
+    log_wakeup ();
+}
+
+
+/* wait until everything logged so far has been written */
+void log_flush (void)
+{
+  log_publish (&event_out);
+  while (log_out.head != log_out.tail || event_out.head != event_out.tail) {
+    log_wakeup ();
+#ifndef WIN32
+    sched_yield ();
+#endif
+  }
+}
+
+
+/* in a forked child there is no writer; leave the rings to the parent,
+   write our own lines at once and no events */
+void log_child (void)
+{
+  log_out.tail = log_out.head = log_out.fill;
+  event_out.tail = event_out.head = event_out.fill;
+  event_stream = FALSE;
+  log_threaded = FALSE;
+  log_direct = TRUE;
+}
+
+
+/* the first record of each event file says what the records are */
+static void event_start (struct log_ring *ring)
+{
+  struct event_u rec;
+
+  rec.time = time (0);
+  rec.pulse = log_pulses;
+  rec.type = EVENT_FILE;
+  rec.room = -1;
+  rec.actor = EVENT_MAGIC;
+  rec.target = sizeof (struct event_u);
+  rec.value = EVENT_VERSION;
+  rec.extra = 0;
+  log_write (ring->fd, (char *) &rec, sizeof (rec));
+  ring->written += sizeof (rec);
+}
+
+
+/* write events to file from now on; call it after log_open() */
+void event_open (char *file)
+{
+  log_path_set (event_path, file);
+  if (!log_file_open (&event_out)) {
+    perror (event_path);
+    *event_path = '\0';
+    return;
+  }
+  event_stream = TRUE;
+}
+
+
+/* how an event names ch, see struct event_u */
+int event_id (struct char_data *ch)
+{
+  int i;
+
+  extern struct index_data *mob_index;
+  extern struct player_index_element *player_table;
+  extern int top_of_p_table;
+
+  if (IS_NPC (ch))
+    return (ch->nr >= 0 ? mob_index[ch->nr].virtual : 0);
+  if (ch->desc)
+    return (-1 - ch->desc->pos);
+
+  /* link dead */
+  for (i = 0; i <= top_of_p_table; i++)
+    if (!str_cmp (player_table[i].name, GET_NAME (ch)))
+      return (-1 - player_table[i].nr);
+  return (0);
+}
+
+
+/* add an event done by ch, if anyone, where ch is; use EVENT() */
+void event (int type, struct char_data *ch, int target, int value,
+  int extra)
+{
+  struct event_u rec;
+
+  extern struct room_data *world;
+
+  if (!log_pulsing)
+    log_stamp_update ();
+
+  rec.time = log_time;
+  rec.pulse = log_pulses;
+  rec.type = type;
+  rec.room = (ch && ch->in_room != NOWHERE) ? world[ch->in_room].number : -1;
+  rec.actor = ch ? event_id (ch) : 0;
+  rec.target = target;
+  rec.value = value;
+  rec.extra = extra;
 
-  ct = time (0);
-  tmstr = asctime (localtime (&ct));
-  *(tmstr + strlen (tmstr) - 1) = '\0';
-  fprintf (stderr, "%s :: %s\n", tmstr, str);
+  log_ring_room (&event_out, sizeof (rec));
+  log_put (&event_out, 0, (char *) &rec, sizeof (rec));
+  event_out.fill += sizeof (rec);       /* the writer sees it next pulse */
 }
 
 
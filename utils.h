@@ -11,6 +11,33 @@
 
 #define UPPER(c) (((c)>='a'  && (c) <= 'z') ? ((c)+('A'-'a')) : (c) )
 
+/* Random number streams, see rng_number() in utility.c */
+#define RNG_WORLD   0           /* Anything not listed below      */
+#define RNG_COMBAT  1           /* hit(), damage(), saving throws */
+#define RNG_AI      2           /* mobile_activity()              */
+#define RNG_LOOT    3           /* read_mobile(), so zone resets  */
+#define MAX_RNG     4
+
+/* Parts of the game that log, see log_at() in utility.c, and how much */
+#define LOG_GAME     0          /* Anything not listed below      */
+#define LOG_BOOT     1          /* Loading and resetting the world */
+#define LOG_CONNECT  2          /* Players coming and going       */
+#define LOG_COMMANDS 3          /* Commands of PLR_LOG players    */
+#define LOG_SAVE     4          /* Rent, journal and snapshots    */
+#define MAX_LOG      5
+
+#define LOG_DEBUG    0
+#define LOG_INFO     1
+#define LOG_WARN     2
+#define LOG_ERROR    3
+#define LOG_OFF      4
+
+/* Events, see struct event_u.  Nothing is evaluated without -e. */
+extern int event_stream;
+
+#define EVENT(type, ch, target, value, extra) do {\
+  if (event_stream) event ((type), (ch), (target), (value), (extra)); } while(0)
+
 /* Functions in utility.c                     */
 /* #define MAX(a,b) (((a) > (b)) ? (a) : (b)) */
 /* #define MIN(a,b) (((a) < (b)) ? (a) : (b)) */
@@ -37,19 +64,18 @@
 
 #define IS_AFFECTED(ch,skill) ( IS_SET((ch)->specials.affected_by, (skill)) )
 
-#define IS_DARK(room)  (!world[room].light && IS_SET(world[room].room_flags, DARK))
+#define IS_DARK(room)  (world[room].visibility & SIGHT_LIGHT)
 
-#define IS_LIGHT(room)  (world[room].light || !IS_SET(world[room].room_flags, DARK))
+#define IS_LIGHT(room)  (!IS_DARK(room))
 
 #define SET_BIT(var,bit)  ((var) = (var) | (bit))
 
 #define REMOVE_BIT(var,bit)  ((var) = (var) & ~(bit) )
 
 /* Can subject see character "obj"? */
-#define CAN_SEE(sub, obj)   ( ((!IS_AFFECTED((obj),AFF_INVISIBLE) ||        \
-                                 IS_AFFECTED((sub),AFF_DETECT_INVISIBLE)) &&\
-                                !IS_AFFECTED((sub),AFF_BLIND) ) &&            \
-                                 IS_LIGHT(sub->in_room) )
+#define CAN_SEE(sub, obj)   (!(((obj)->specials.visibility |                \
+                                world[(sub)->in_room].visibility) &         \
+                               ~(sub)->specials.sight))
 
 #define GET_REQ(i) (i<2  ? "Awful" :(i<4  ? "Bad"     :(i<7  ? "Poor"      :\
 (i<10 ? "Average" :(i<14 ? "Fair"    :(i<20 ? "Good"    :(i<24 ? "Very good" :\
@@ -145,10 +171,13 @@
 
 /* Object And Carry related macros */
 
+#define OBJ_VISIBILITY(obj)                                      \
+  (IS_SET((obj)->obj_flags.extra_flags, ITEM_INVISIBLE) ?         \
+    SIGHT_EYES | SIGHT_INVISIBLE : SIGHT_EYES)
+
 #define CAN_SEE_OBJ(sub, obj)                                    \
-  ( (( !IS_SET((obj)->obj_flags.extra_flags, ITEM_INVISIBLE) ||   \
-       IS_AFFECTED((sub),AFF_DETECT_INVISIBLE) ) &&               \
-       !IS_AFFECTED((sub),AFF_BLIND)) && IS_LIGHT(sub->in_room) )
+  (!((OBJ_VISIBILITY(obj) | world[(sub)->in_room].visibility) &   \
+     ~(sub)->specials.sight))
 
 #define GET_ITEM_TYPE(obj) ((obj)->obj_flags.type_flag)
 